@@ -0,0 +1,216 @@
+#include "ApproximateMatch.h"
+#include <algorithm>
+#include <bit>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define APPROXIMATEMATCH_SSE2 1
+#endif
+
+static inline unsigned char lower_ascii(unsigned char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c | 0x20) : c;
+}
+
+static inline unsigned char upper_ascii(unsigned char c)
+{
+    return (c >= 'a' && c <= 'z') ? static_cast<unsigned char>(c & ~0x20) : c;
+}
+
+ApproximatePattern::ApproximatePattern(std::string_view pattern, size_t max_edits, bool case_sensitive)
+    : case_sensitive_(case_sensitive)
+{
+    // Ogni pezzo almeno due byte: il filtro ne confronta due
+    const size_t m = pattern.size();
+    max_edits = std::min({max_edits, kMaxEdits, m / 2 > 0 ? m / 2 - 1 : size_t{0}});
+    if (m > kMaxLength || max_edits == 0)
+    {
+        return;
+    }
+    max_edits_ = max_edits;
+    for (char c : pattern)
+    {
+        const unsigned char u = static_cast<unsigned char>(c);
+        pattern_.push_back(static_cast<char>(case_sensitive ? u : lower_ascii(u)));
+    }
+
+    for (size_t i = 0; i < m; ++i)
+    {
+        const unsigned char u = static_cast<unsigned char>(pattern_[i]);
+        peq_[u] |= uint64_t{1} << i;
+        if (!case_sensitive)
+        {
+            peq_[upper_ascii(u)] |= uint64_t{1} << i;
+        }
+    }
+
+    // k+1 pezzi, il resto della divisione va ai primi
+    const size_t parts = max_edits_ + 1;
+    size_t offset = 0;
+    for (size_t i = 0; i < parts; ++i)
+    {
+        const size_t length = m / parts + (i < m % parts ? 1 : 0);
+        pieces_.push_back({offset, pattern_.substr(offset, length)});
+        offset += length;
+    }
+}
+
+bool ApproximatePattern::piece_at(const char *data, size_t size, size_t pos, const Piece &piece) const
+{
+    if (pos + piece.bytes.size() > size)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < piece.bytes.size(); ++i)
+    {
+        const unsigned char u = static_cast<unsigned char>(data[pos + i]);
+        if ((case_sensitive_ ? u : lower_ascii(u)) != static_cast<unsigned char>(piece.bytes[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ApproximatePattern::scan(const char *data, size_t size, size_t from, size_t to,
+                              Region &pending, std::vector<Match> &out) const
+{
+    if (!valid())
+    {
+        return;
+    }
+    to = std::min(to, size);
+    const size_t m = pattern_.size();
+    const size_t k = max_edits_;
+
+    // Un pezzo trovato in pos: l'occorrenza che lo contiene inizia al più
+    // k byte prima del suo posto nel pattern e finisce al più k byte dopo.
+    // Le zone vicine si fondono; una zona si verifica quando nessun pezzo
+    // successivo può più toccarla.
+    auto candidate = [&](size_t pos, const Piece &piece) {
+        const size_t anchor = pos >= piece.offset ? pos - piece.offset : 0;
+        const Region region{anchor >= k ? anchor - k : 0, std::min(size, anchor + m + k)};
+        if (pending.end > pending.begin)
+        {
+            if (pos > pending.end + m + k)
+            {
+                verify(data, pending, out);
+                pending = region;
+                return;
+            }
+            pending.begin = std::min(pending.begin, region.begin);
+            pending.end = std::max(pending.end, region.end);
+            return;
+        }
+        pending = region;
+    };
+    auto check = [&](size_t pos) {
+        for (const Piece &piece : pieces_)
+        {
+            if (piece_at(data, size, pos, piece))
+            {
+                candidate(pos, piece);
+            }
+        }
+    };
+
+    size_t i = from;
+#ifdef APPROXIMATEMATCH_SSE2
+    // Filtro sui primi due byte di ogni pezzo, entrambe le varianti di case
+    __m128i first_lo[kMaxEdits + 1], first_up[kMaxEdits + 1];
+    __m128i second_lo[kMaxEdits + 1], second_up[kMaxEdits + 1];
+    for (size_t p = 0; p < pieces_.size(); ++p)
+    {
+        const unsigned char c0 = static_cast<unsigned char>(pieces_[p].bytes[0]);
+        const unsigned char c1 = static_cast<unsigned char>(pieces_[p].bytes[1]);
+        first_lo[p] = _mm_set1_epi8(static_cast<char>(c0));
+        first_up[p] = _mm_set1_epi8(static_cast<char>(case_sensitive_ ? c0 : upper_ascii(c0)));
+        second_lo[p] = _mm_set1_epi8(static_cast<char>(c1));
+        second_up[p] = _mm_set1_epi8(static_cast<char>(case_sensitive_ ? c1 : upper_ascii(c1)));
+    }
+    for (; i < to && i + 1 + 16 <= size; i += 16)
+    {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 1));
+        __m128i hits = _mm_setzero_si128();
+        for (size_t p = 0; p < pieces_.size(); ++p)
+        {
+            const __m128i first = _mm_or_si128(_mm_cmpeq_epi8(a, first_lo[p]), _mm_cmpeq_epi8(a, first_up[p]));
+            const __m128i second = _mm_or_si128(_mm_cmpeq_epi8(b, second_lo[p]), _mm_cmpeq_epi8(b, second_up[p]));
+            hits = _mm_or_si128(hits, _mm_and_si128(first, second));
+        }
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+        if (to - i < 16)
+        {
+            mask &= (1u << (to - i)) - 1; // solo le posizioni di questa finestra
+        }
+        while (mask != 0)
+        {
+            check(i + static_cast<size_t>(std::countr_zero(mask)));
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i < to; ++i)
+    {
+        check(i);
+    }
+
+    if (to == size && pending.end > pending.begin)
+    {
+        verify(data, pending, out);
+        pending = {};
+    }
+}
+
+void ApproximatePattern::verify(const char *data, Region region, std::vector<Match> &out) const
+{
+    // Myers (1999): colonna della matrice di programmazione dinamica come
+    // differenze verticali +1/-1 (pv/mv); la riga zero vale sempre 0, così
+    // l'occorrenza può iniziare ovunque. score è l'ultima riga: la distanza
+    // migliore di una sottostringa che finisce nel byte corrente.
+    const size_t m = pattern_.size();
+    const size_t k = max_edits_;
+    const uint64_t last = uint64_t{1} << (m - 1);
+    uint64_t pv = ~uint64_t{0};
+    uint64_t mv = 0;
+    size_t score = m;
+
+    bool in_run = false;
+    Match best;
+    for (size_t j = region.begin; j < region.end; ++j)
+    {
+        const uint64_t eq = peq_[static_cast<unsigned char>(data[j])];
+        const uint64_t xv = eq | mv;
+        const uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        score += (ph & last) != 0;
+        score -= (mh & last) != 0;
+        ph <<= 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        if (score <= k)
+        {
+            if (!in_run || score < best.distance)
+            {
+                best.end = j + 1;
+                best.distance = score;
+            }
+            in_run = true;
+        }
+        else if (in_run)
+        {
+            best.begin = best.end >= m ? best.end - m : 0;
+            out.push_back(best);
+            in_run = false;
+        }
+    }
+    if (in_run)
+    {
+        best.begin = best.end >= m ? best.end - m : 0;
+        out.push_back(best);
+    }
+}
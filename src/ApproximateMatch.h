@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Ricerca approssimata: occorrenze del pattern con al più k errori
+// (inserimenti, cancellazioni, sostituzioni), per i nomi scritti male
+// ("Charachter", "Weopon").
+//
+// Due passaggi. Filtro: il pattern si divide in k+1 pezzi e un'occorrenza
+// con k errori ne contiene almeno uno intatto (piccionaia), quindi si
+// cercano solo i pezzi, con lo stesso filtro SIMD sui primi due byte della
+// ricerca letterale. Verifica: attorno a ogni pezzo trovato gira l'automa
+// bit-parallel di Myers (una parola a 64 bit per tutto il pattern, una
+// manciata di operazioni per byte) che dà la distanza di edit minima di
+// ogni sottostringa che finisce in quel punto.
+class ApproximatePattern
+{
+public:
+    static constexpr size_t kMaxLength = 64; // una parola macchina
+    static constexpr size_t kMaxEdits = 3;
+
+    // Un'occorrenza: una sequenza di fine posizioni consecutive entro k
+    // errori conta una volta, con la distanza migliore
+    struct Match
+    {
+        size_t begin = 0; // stimato: end - lunghezza del pattern
+        size_t end = 0;   // escluso
+        size_t distance = 0;
+    };
+
+    // Zona da verificare ancora aperta tra una finestra e la successiva
+    struct Region
+    {
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    ApproximatePattern() = default;
+    // max_edits ridotto finché ogni pezzo ha almeno due byte; non valido
+    // (ricerca esatta) se il pattern è più lungo di kMaxLength, più corto
+    // di 4 byte o se max_edits è 0
+    ApproximatePattern(std::string_view pattern, size_t max_edits, bool case_sensitive);
+
+    bool valid() const { return max_edits_ > 0; }
+    size_t max_edits() const { return max_edits_; }
+    size_t length() const { return pattern_.size(); }
+
+    // Occorrenze i cui pezzi iniziano in data[from, to), in coda a out in
+    // ordine di fine. La verifica può proseguire oltre to: le zone aperte
+    // restano in pending per la chiamata successiva (to == size le chiude).
+    void scan(const char *data, size_t size, size_t from, size_t to,
+              Region &pending, std::vector<Match> &out) const;
+
+private:
+    struct Piece
+    {
+        size_t offset;
+        std::string bytes; // già in minuscolo se !case_sensitive
+    };
+
+    void verify(const char *data, Region region, std::vector<Match> &out) const;
+    bool piece_at(const char *data, size_t size, size_t pos, const Piece &piece) const;
+
+    std::string pattern_;
+    size_t max_edits_ = 0;
+    bool case_sensitive_ = false;
+    std::vector<Piece> pieces_;
+    uint64_t peq_[256] = {}; // bit i: il byte combacia con pattern_[i]
+};
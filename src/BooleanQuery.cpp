@@ -0,0 +1,624 @@
+#include "BooleanQuery.h"
+#include <algorithm>
+#include <bit>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define BOOLEANQUERY_SSE2 1
+#endif
+
+static inline unsigned char lower_ascii(unsigned char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c | 0x20) : c;
+}
+
+static inline unsigned char upper_ascii(unsigned char c)
+{
+    return (c >= 'a' && c <= 'z') ? static_cast<unsigned char>(c & ~0x20) : c;
+}
+
+// Come per il whole-word della ricerca normale: lettere, numeri, '_' e '-'
+static inline bool is_identifier_char(char c)
+{
+    const unsigned char u = static_cast<unsigned char>(c);
+    return (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') || (u >= '0' && u <= '9') || u == '_' || u == '-';
+}
+
+static bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+struct QueryToken
+{
+    enum class Kind { Term, And, Or, Not, Open, Close };
+    Kind kind = Kind::Term;
+    BooleanQuery::TermKind term_kind = BooleanQuery::TermKind::Literal;
+    std::string_view text; // il termine, senza modificatore né virgolette
+};
+
+// Modificatore all'inizio di un termine ("re:", "word:", "lit:"); avanza pos
+static bool read_modifier(std::string_view query, size_t &pos, BooleanQuery::TermKind &kind)
+{
+    static constexpr struct
+    {
+        std::string_view prefix;
+        BooleanQuery::TermKind kind;
+    } kModifiers[] = {
+        {"re:", BooleanQuery::TermKind::Regex},
+        {"word:", BooleanQuery::TermKind::WholeWord},
+        {"lit:", BooleanQuery::TermKind::Literal},
+    };
+    for (const auto &modifier : kModifiers)
+    {
+        if (query.compare(pos, modifier.prefix.size(), modifier.prefix) == 0)
+        {
+            pos += modifier.prefix.size();
+            kind = modifier.kind;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool tokenize(std::string_view query, std::vector<QueryToken> &tokens, std::string &error)
+{
+    size_t pos = 0;
+    while (pos < query.size())
+    {
+        if (is_space(query[pos]))
+        {
+            ++pos;
+            continue;
+        }
+        if (query[pos] == '(' || query[pos] == ')')
+        {
+            QueryToken token;
+            token.kind = query[pos] == '(' ? QueryToken::Kind::Open : QueryToken::Kind::Close;
+            tokens.push_back(token);
+            ++pos;
+            continue;
+        }
+
+        QueryToken token;
+        const bool modified = read_modifier(query, pos, token.term_kind);
+        const bool quoted = pos < query.size() && query[pos] == '"';
+        if (quoted)
+        {
+            const size_t close = query.find('"', pos + 1);
+            if (close == std::string_view::npos)
+            {
+                error = "missing closing quote";
+                return false;
+            }
+            token.text = query.substr(pos + 1, close - pos - 1);
+            pos = close + 1;
+        }
+        else
+        {
+            const size_t begin = pos;
+            while (pos < query.size() && !is_space(query[pos]) && query[pos] != '(' && query[pos] != ')')
+            {
+                ++pos;
+            }
+            token.text = query.substr(begin, pos - begin);
+        }
+
+        if (!modified && !quoted)
+        {
+            if (token.text == "AND") token.kind = QueryToken::Kind::And;
+            else if (token.text == "OR") token.kind = QueryToken::Kind::Or;
+            else if (token.text == "NOT") token.kind = QueryToken::Kind::Not;
+        }
+        if (token.kind == QueryToken::Kind::Term && token.text.empty())
+        {
+            error = "empty term";
+            return false;
+        }
+        tokens.push_back(token);
+    }
+    return true;
+}
+
+bool BooleanQuery::looks_like_query(std::string_view pattern)
+{
+    size_t pos = 0;
+    while (pos < pattern.size())
+    {
+        // Parola per parola: separatori sono spazi e parentesi
+        while (pos < pattern.size() && (is_space(pattern[pos]) || pattern[pos] == '(' || pattern[pos] == ')'))
+        {
+            ++pos;
+        }
+        const size_t begin = pos;
+        TermKind kind;
+        if (read_modifier(pattern, pos, kind))
+        {
+            return true;
+        }
+        while (pos < pattern.size() && !is_space(pattern[pos]) && pattern[pos] != '(' && pattern[pos] != ')')
+        {
+            ++pos;
+        }
+        const std::string_view word = pattern.substr(begin, pos - begin);
+        if (word == "AND" || word == "OR" || word == "NOT")
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string BooleanQuery::map_terms(std::string_view query, const std::function<std::string(std::string_view)> &fn)
+{
+    std::vector<QueryToken> tokens;
+    std::string error;
+    if (!tokenize(query, tokens, error))
+    {
+        return std::string(query);
+    }
+    // I termini sono viste dentro query: si ricopia il testo tra l'uno e l'altro
+    std::string out;
+    size_t copied = 0;
+    for (const QueryToken &token : tokens)
+    {
+        if (token.kind != QueryToken::Kind::Term || token.term_kind == TermKind::Regex)
+        {
+            continue;
+        }
+        const size_t begin = static_cast<size_t>(token.text.data() - query.data());
+        out.append(query.substr(copied, begin - copied));
+        out.append(fn(token.text));
+        copied = begin + token.text.size();
+    }
+    out.append(query.substr(copied));
+    return out;
+}
+
+// Discesa ricorsiva: or := and (OR and)*, and := unary ([AND] unary)*,
+// unary := NOT unary | '(' or ')' | termine
+class QueryParser
+{
+public:
+    QueryParser(BooleanQuery &query, const std::vector<QueryToken> &tokens, std::string &error)
+        : query_(query), tokens_(tokens), error_(error)
+    {
+    }
+
+    bool parse()
+    {
+        if (tokens_.empty())
+        {
+            error_ = "empty query";
+            return false;
+        }
+        uint32_t root = 0;
+        if (!parse_or(false, root))
+        {
+            return false;
+        }
+        if (pos_ < tokens_.size())
+        {
+            error_ = tokens_[pos_].kind == QueryToken::Kind::Close ? "unbalanced ')'" : "unexpected operator";
+            return false;
+        }
+        query_.root_ = root;
+        return true;
+    }
+
+private:
+    using Node = BooleanQuery::Node;
+    using Kind = QueryToken::Kind;
+
+    bool at(Kind kind) const { return pos_ < tokens_.size() && tokens_[pos_].kind == kind; }
+
+    uint32_t add(Node::Op op, uint32_t left, uint32_t right)
+    {
+        query_.nodes_.push_back({op, left, right});
+        return static_cast<uint32_t>(query_.nodes_.size() - 1);
+    }
+
+    bool parse_or(bool negated, uint32_t &node)
+    {
+        if (!parse_and(negated, node))
+        {
+            return false;
+        }
+        while (at(Kind::Or))
+        {
+            ++pos_;
+            uint32_t right = 0;
+            if (!parse_and(negated, right))
+            {
+                return false;
+            }
+            node = add(Node::Op::Or, node, right);
+        }
+        return true;
+    }
+
+    bool parse_and(bool negated, uint32_t &node)
+    {
+        if (!parse_unary(negated, node))
+        {
+            return false;
+        }
+        // AND esplicito, o due termini/gruppi vicini
+        while (at(Kind::And) || at(Kind::Not) || at(Kind::Open) || at(Kind::Term))
+        {
+            if (at(Kind::And))
+            {
+                ++pos_;
+            }
+            uint32_t right = 0;
+            if (!parse_unary(negated, right))
+            {
+                return false;
+            }
+            node = add(Node::Op::And, node, right);
+        }
+        return true;
+    }
+
+    bool parse_unary(bool negated, uint32_t &node)
+    {
+        if (pos_ >= tokens_.size())
+        {
+            error_ = "missing term at the end";
+            return false;
+        }
+        const QueryToken &token = tokens_[pos_++];
+        switch (token.kind)
+        {
+        case Kind::Not:
+        {
+            uint32_t inner = 0;
+            if (!parse_unary(!negated, inner))
+            {
+                return false;
+            }
+            node = add(Node::Op::Not, inner, 0);
+            return true;
+        }
+        case Kind::Open:
+            if (!parse_or(negated, node))
+            {
+                return false;
+            }
+            if (!at(Kind::Close))
+            {
+                error_ = "missing ')'";
+                return false;
+            }
+            ++pos_;
+            return true;
+        case Kind::Term:
+        {
+            uint32_t term = 0;
+            if (!add_term(token, negated, term))
+            {
+                return false;
+            }
+            node = add(Node::Op::Term, term, 0);
+            return true;
+        }
+        default:
+            error_ = token.kind == Kind::Close ? "unbalanced ')'" : "operator without a term";
+            return false;
+        }
+    }
+
+    // Lo stesso termine scritto due volte è un termine solo
+    bool add_term(const QueryToken &token, bool negated, uint32_t &index)
+    {
+        auto &terms = query_.terms_;
+        auto same = std::find_if(terms.begin(), terms.end(), [&](const BooleanQuery::Term &term) {
+            return term.kind == token.term_kind && term.text == token.text;
+        });
+        if (same == terms.end())
+        {
+            if (terms.size() >= BooleanQuery::kMaxTerms)
+            {
+                error_ = "too many terms (max " + std::to_string(BooleanQuery::kMaxTerms) + ")";
+                return false;
+            }
+            BooleanQuery::Term term;
+            term.kind = token.term_kind;
+            term.text = std::string(token.text);
+            term.needle = term.text;
+            if (!query_.case_sensitive_)
+            {
+                std::transform(term.needle.begin(), term.needle.end(), term.needle.begin(),
+                               [](char c) { return static_cast<char>(lower_ascii(static_cast<unsigned char>(c))); });
+            }
+            if (term.kind == BooleanQuery::TermKind::Regex)
+            {
+                try
+                {
+                    term.regex = query_.case_sensitive_ ? std::regex(term.text)
+                                                        : std::regex(term.text, std::regex_constants::icase);
+                }
+                catch (const std::regex_error &e)
+                {
+                    error_ = "invalid regex '" + term.text + "': " + e.what();
+                    return false;
+                }
+            }
+            terms.push_back(std::move(term));
+            same = terms.end() - 1;
+        }
+        index = static_cast<uint32_t>(same - terms.begin());
+        if (!negated)
+        {
+            same->positive = true;
+        }
+        return true;
+    }
+
+    BooleanQuery &query_;
+    const std::vector<QueryToken> &tokens_;
+    std::string &error_;
+    size_t pos_ = 0;
+};
+
+bool BooleanQuery::parse(std::string_view query, bool case_sensitive, std::string &error)
+{
+    terms_.clear();
+    nodes_.clear();
+    root_ = 0;
+    literal_mask_ = 0;
+    positive_mask_ = 0;
+    case_sensitive_ = case_sensitive;
+    primary_.clear();
+
+    std::vector<QueryToken> tokens;
+    if (!tokenize(query, tokens, error) || !QueryParser(*this, tokens, error).parse())
+    {
+        terms_.clear();
+        nodes_.clear();
+        return false;
+    }
+
+    for (size_t i = 0; i < terms_.size(); ++i)
+    {
+        const uint32_t bit = uint32_t{1} << i;
+        if (terms_[i].kind != TermKind::Regex)
+        {
+            literal_mask_ |= bit;
+            if (terms_[i].positive && primary_.empty())
+            {
+                primary_ = terms_[i].text;
+            }
+        }
+        if (terms_[i].positive)
+        {
+            positive_mask_ |= bit;
+        }
+    }
+
+    // Un risultato deve contenere almeno un termine: con tutti i termini
+    // assenti la query deve essere falsa ("NOT Deprecated" o "A OR NOT B"
+    // darebbero quasi ogni file, senza occorrenze da contare). Basta provare
+    // "tutti falsi": i termini solo negati danno il massimo proprio da falsi.
+    FileState absent(*this, 0);
+    absent.values.fill(Truth::False);
+    if (evaluate(absent, root_) == Truth::True)
+    {
+        error = "the query also matches files that contain none of its terms; add a term that is not negated";
+        terms_.clear();
+        nodes_.clear();
+        literal_mask_ = positive_mask_ = 0;
+        primary_.clear();
+        return false;
+    }
+    return true;
+}
+
+BooleanQuery::FileState::FileState(const BooleanQuery &query, size_t header_end)
+    : active(query.literal_mask_), header_end(header_end)
+{
+    values.fill(Truth::Unknown);
+}
+
+// A tre valori: falso domina l'AND, vero domina l'OR
+BooleanQuery::Truth BooleanQuery::evaluate(const FileState &state, uint32_t node) const
+{
+    const Node &n = nodes_[node];
+    switch (n.op)
+    {
+    case Node::Op::Term:
+        return state.values[n.left];
+    case Node::Op::Not:
+    {
+        const Truth inner = evaluate(state, n.left);
+        return inner == Truth::Unknown ? inner : (inner == Truth::True ? Truth::False : Truth::True);
+    }
+    case Node::Op::And:
+    {
+        const Truth left = evaluate(state, n.left);
+        if (left == Truth::False) return left;
+        const Truth right = evaluate(state, n.right);
+        if (right == Truth::False) return right;
+        return left == Truth::True && right == Truth::True ? Truth::True : Truth::Unknown;
+    }
+    case Node::Op::Or:
+    {
+        const Truth left = evaluate(state, n.left);
+        if (left == Truth::True) return left;
+        const Truth right = evaluate(state, n.right);
+        if (right == Truth::True) return right;
+        return left == Truth::False && right == Truth::False ? Truth::False : Truth::Unknown;
+    }
+    }
+    return Truth::Unknown;
+}
+
+void BooleanQuery::update(size_t max_count, FileState &state) const
+{
+    state.result = evaluate(state, root_);
+    if (state.result == Truth::False)
+    {
+        state.active = 0;
+        return;
+    }
+    // Deciso o no, i termini non negati restano per il conteggio finché
+    // non satura; i termini non ancora trovati servono solo se non è deciso
+    uint32_t unknown = 0;
+    for (size_t i = 0; i < terms_.size(); ++i)
+    {
+        if (state.values[i] == Truth::Unknown)
+        {
+            unknown |= uint32_t{1} << i;
+        }
+    }
+    const uint32_t counting = state.count < max_count ? positive_mask_ & literal_mask_ : 0;
+    state.active = state.result == Truth::True ? counting : (unknown & literal_mask_) | counting;
+}
+
+bool BooleanQuery::term_at(const Term &term, const char *data, size_t size, size_t pos) const
+{
+    const std::string &needle = term.needle;
+    if (pos + needle.size() > size)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < needle.size(); ++i)
+    {
+        const unsigned char u = static_cast<unsigned char>(data[pos + i]);
+        if ((case_sensitive_ ? u : lower_ascii(u)) != static_cast<unsigned char>(needle[i]))
+        {
+            return false;
+        }
+    }
+    if (term.kind == TermKind::WholeWord)
+    {
+        const size_t end = pos + needle.size();
+        return (pos == 0 || !is_identifier_char(data[pos - 1])) && (end >= size || !is_identifier_char(data[end]));
+    }
+    return true;
+}
+
+void BooleanQuery::scan(const char *data, size_t size, size_t from, size_t to, size_t max_count,
+                        FileState &state) const
+{
+    if (state.active == 0)
+    {
+        return;
+    }
+    to = std::min(to, size);
+
+    uint32_t active_terms[kMaxTerms];
+    size_t active_count = 0;
+    for (uint32_t mask = state.active; mask != 0; mask &= mask - 1)
+    {
+        active_terms[active_count++] = static_cast<uint32_t>(std::countr_zero(mask));
+    }
+
+    auto check = [&](size_t pos) {
+        for (size_t a = 0; a < active_count; ++a)
+        {
+            const uint32_t t = active_terms[a];
+            const Term &term = terms_[t];
+            if (!term_at(term, data, size, pos))
+            {
+                continue;
+            }
+            state.values[t] = Truth::True;
+            // Occorrenze sovrapposte dello stesso termine contano una volta
+            if (term.positive && pos >= state.next[t] && state.count < max_count)
+            {
+                ++state.count;
+                if (pos < state.header_end) ++state.header_count;
+                state.next[t] = pos + term.needle.size();
+            }
+        }
+    };
+
+    size_t i = from;
+#ifdef BOOLEANQUERY_SSE2
+    // Filtro sul primo e sull'ultimo byte di ogni termine attivo, entrambe
+    // le varianti di case: i due estremi scartano più candidati di due byte
+    // vicini, che nei testi di identificatori si ripetono spesso
+    __m128i first_lo[kMaxTerms], first_up[kMaxTerms];
+    __m128i last_lo[kMaxTerms], last_up[kMaxTerms];
+    size_t last_at[kMaxTerms];
+    size_t longest = 1;
+    for (size_t a = 0; a < active_count; ++a)
+    {
+        const std::string &needle = terms_[active_terms[a]].needle;
+        const unsigned char c0 = static_cast<unsigned char>(needle.front());
+        const unsigned char c1 = static_cast<unsigned char>(needle.back());
+        first_lo[a] = _mm_set1_epi8(static_cast<char>(c0));
+        first_up[a] = _mm_set1_epi8(static_cast<char>(case_sensitive_ ? c0 : upper_ascii(c0)));
+        last_lo[a] = _mm_set1_epi8(static_cast<char>(c1));
+        last_up[a] = _mm_set1_epi8(static_cast<char>(case_sensitive_ ? c1 : upper_ascii(c1)));
+        last_at[a] = needle.size() - 1;
+        longest = std::max(longest, needle.size());
+    }
+    for (; i < to && i + longest - 1 + 16 <= size; i += 16)
+    {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        __m128i hits = _mm_setzero_si128();
+        for (size_t t = 0; t < active_count; ++t)
+        {
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + last_at[t]));
+            const __m128i first = _mm_or_si128(_mm_cmpeq_epi8(a, first_lo[t]), _mm_cmpeq_epi8(a, first_up[t]));
+            const __m128i last = _mm_or_si128(_mm_cmpeq_epi8(b, last_lo[t]), _mm_cmpeq_epi8(b, last_up[t]));
+            hits = _mm_or_si128(hits, _mm_and_si128(first, last));
+        }
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+        if (to - i < 16)
+        {
+            mask &= (1u << (to - i)) - 1; // solo le posizioni di questa finestra
+        }
+        while (mask != 0)
+        {
+            check(i + static_cast<size_t>(std::countr_zero(mask)));
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i < to; ++i)
+    {
+        check(i);
+    }
+
+    update(max_count, state);
+}
+
+bool BooleanQuery::finish(const char *data, size_t size, size_t max_count, FileState &state) const
+{
+    if (state.result == Truth::False)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < terms_.size(); ++i)
+    {
+        if (terms_[i].kind != TermKind::Regex && state.values[i] == Truth::Unknown)
+        {
+            state.values[i] = Truth::False;
+        }
+    }
+
+    // Le regex in ordine di scrittura, finché il risultato resta aperto
+    Truth result = evaluate(state, root_);
+    for (size_t i = 0; i < terms_.size() && result == Truth::Unknown; ++i)
+    {
+        const Term &term = terms_[i];
+        if (term.kind != TermKind::Regex)
+        {
+            continue;
+        }
+        std::cmatch match;
+        const bool found = std::regex_search(data, data + size, match, term.regex);
+        state.values[i] = found ? Truth::True : Truth::False;
+        if (found && term.positive && state.count < max_count)
+        {
+            ++state.count;
+            if (static_cast<size_t>(match.position()) < state.header_end) ++state.header_count;
+        }
+        result = evaluate(state, root_);
+    }
+    state.result = result;
+    return result == Truth::True;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Query booleana sul contenuto dei file, scritta nel campo del pattern:
+//
+//   DamageComponent AND Shield AND NOT Deprecated
+//   (word:Health OR re:"Shield(s|Component)") NOT Deprecated
+//
+// Operatori AND, OR, NOT (maiuscoli) e parentesi; due termini vicini senza
+// operatore sono in AND. Un termine è letterale, salvo i modificatori
+// "word:" (parola intera) e "re:" (regex); "lit:" forza il letterale anche
+// per una parola che sembra un operatore. Spazi e parentesi in un termine
+// vanno tra virgolette.
+//
+// Tutti i termini letterali si cercano insieme in un solo passaggio sul
+// file (filtro SIMD sul primo e sull'ultimo byte di ognuno). A ogni
+// finestra la query si valuta a tre valori (vero, falso, non ancora noto):
+// appena il risultato è deciso la scansione si ferma, e i termini che non
+// possono più cambiarlo escono dal filtro. Le regex, lente, girano solo
+// alla fine e solo se servono ancora a decidere.
+class BooleanQuery
+{
+public:
+    static constexpr size_t kMaxTerms = 32;
+
+    enum class Truth : uint8_t
+    {
+        False,
+        True,
+        Unknown,
+    };
+
+    enum class TermKind : uint8_t
+    {
+        Literal,
+        WholeWord,
+        Regex,
+    };
+
+    // Stato della scansione di un file, un passaggio alla volta
+    struct FileState
+    {
+        FileState(const BooleanQuery &query, size_t header_end);
+
+        std::array<Truth, kMaxTerms> values;
+        std::array<size_t, kMaxTerms> next{}; // fine dell'ultima occorrenza contata
+        uint32_t active = 0;                  // termini letterali ancora da cercare (bit = indice)
+        Truth result = Truth::Unknown;
+        size_t header_end = 0;
+        size_t count = 0;        // occorrenze dei termini non negati
+        size_t header_count = 0; // di cui nell'header del package
+    };
+
+    // Il pattern usa la sintassi delle query: contiene AND, OR o NOT come
+    // parole o un termine con modificatore. Gli altri pattern (parentesi
+    // comprese, che sono delle regex) restano com'erano.
+    static bool looks_like_query(std::string_view pattern);
+
+    // Riscrive i termini letterali (es. togliere i prefissi Unreal da
+    // ognuno), lasciando il resto della query com'è
+    static std::string map_terms(std::string_view query, const std::function<std::string(std::string_view)> &fn);
+
+    // false con un messaggio in error se la query non è valida, anche quando
+    // sarebbe vera per un file senza nessuno dei suoi termini
+    bool parse(std::string_view query, bool case_sensitive, std::string &error);
+
+    size_t term_count() const { return terms_.size(); }
+    // Il primo termine letterale non negato (ranking sul nome, ordine di
+    // scansione); vuoto se non ce ne sono
+    const std::string &primary_term() const { return primary_; }
+
+    // Termini letterali le cui occorrenze iniziano in data[from, to)
+    void scan(const char *data, size_t size, size_t from, size_t to, size_t max_count, FileState &state) const;
+    // Fine del file: i termini non trovati sono falsi, le regex ancora utili
+    // girano sul buffer intero. true se il file soddisfa la query.
+    bool finish(const char *data, size_t size, size_t max_count, FileState &state) const;
+
+private:
+    struct Term
+    {
+        TermKind kind = TermKind::Literal;
+        std::string text;     // come scritto
+        std::string needle;   // in minuscolo se !case_sensitive
+        bool positive = false; // compare almeno una volta non negato
+        std::regex regex;
+    };
+
+    struct Node
+    {
+        enum class Op : uint8_t { Term, And, Or, Not };
+        Op op = Op::Term;
+        uint32_t left = 0; // Term: indice del termine
+        uint32_t right = 0;
+    };
+
+    friend class QueryParser;
+
+    Truth evaluate(const FileState &state, uint32_t node) const;
+    void update(size_t max_count, FileState &state) const;
+    bool term_at(const Term &term, const char *data, size_t size, size_t pos) const;
+
+    std::vector<Term> terms_;
+    std::vector<Node> nodes_;
+    uint32_t root_ = 0;
+    uint32_t literal_mask_ = 0;  // termini letterali e whole-word
+    uint32_t positive_mask_ = 0;
+    bool case_sensitive_ = false;
+    std::string primary_;
+};
@@ -0,0 +1,174 @@
+#include "ConcurrencyTuner.h"
+#include <algorithm>
+#include <fstream>
+
+// Sotto questa differenza due throughput sono "uguali": il rumore di un
+// intervallo da qualche centinaio di ms è di quest'ordine
+static constexpr double kTolerance = 0.05;
+
+// Intervalli con meno file di così non dicono niente (file enormi, pausa)
+static constexpr uint64_t kMinFilesPerSample = 8;
+
+ConcurrencyTuner::ConcurrencyTuner(size_t max_workers, size_t initial)
+    : max_(std::max<size_t>(1, max_workers)),
+      limit_(std::clamp<size_t>(initial == 0 ? max_workers : initial, 1, std::max<size_t>(1, max_workers)))
+{
+}
+
+void ConcurrencyTuner::leave()
+{
+    {
+        std::scoped_lock<std::mutex> lock(mutex_);
+        --active_;
+    }
+    turn_.notify_one();
+}
+
+void ConcurrencyTuner::wake()
+{
+    {
+        // Sotto lock: chi sta per aspettare vede done() già vero o riceve la notifica
+        std::scoped_lock<std::mutex> lock(mutex_);
+    }
+    turn_.notify_all();
+}
+
+void ConcurrencyTuner::set_limit(size_t limit)
+{
+    limit = std::clamp<size_t>(limit, 1, max_);
+    if (limit == limit_.load()) {
+        return;
+    }
+    {
+        std::scoped_lock<std::mutex> lock(mutex_);
+        limit_ = limit;
+    }
+    turn_.notify_all();
+}
+
+void ConcurrencyTuner::release()
+{
+    {
+        std::scoped_lock<std::mutex> lock(mutex_);
+        released_ = true;
+    }
+    turn_.notify_all();
+}
+
+void ConcurrencyTuner::sample(uint64_t bytes_done, uint64_t files_done)
+{
+    const auto now = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(now - last_time_).count();
+    const uint64_t files = files_done - last_files_;
+    if (seconds <= 0.0 || files < kMinFilesPerSample) {
+        return; // si accumula nel prossimo intervallo
+    }
+    const uint64_t bytes = bytes_done - last_bytes_;
+    // Sui byte, sui file se i byte non dicono niente (solo cache/dedup)
+    const double rate = bytes > 0 ? bytes / seconds : files / seconds;
+    last_time_ = now;
+    last_bytes_ = bytes_done;
+    last_files_ = files_done;
+
+    const size_t current = limit();
+    {
+        std::scoped_lock<std::mutex> lock(best_mutex_);
+        ++samples_;
+        if (rate > best_rate_ * (1.0 + kTolerance) || best_limit_ == 0) {
+            best_rate_ = rate;
+            best_limit_ = current;
+        } else if (rate >= best_rate_ * (1.0 - kTolerance) && current < best_limit_) {
+            best_limit_ = current; // stesso throughput con meno thread
+        }
+    }
+
+    if (samples_ > 1) {
+        if (rate < last_rate_ * (1.0 - kTolerance)) {
+            direction_ = -direction_; // peggio: si torna indietro
+        } else if (rate <= last_rate_ * (1.0 + kTolerance)) {
+            direction_ = -1; // uguale: meno thread, meno contesa
+        }
+    }
+    last_rate_ = rate;
+
+    // Passi piccoli in basso, proporzionali in alto
+    const size_t step = std::max<size_t>(1, current / 4);
+    if (direction_ > 0) {
+        set_limit(current + step);
+    } else if (current > 1) {
+        set_limit(current > step ? current - step : 1);
+    } else {
+        direction_ = 1; // a 1 thread resta solo da salire
+    }
+}
+
+size_t ConcurrencyTuner::best() const
+{
+    std::scoped_lock<std::mutex> lock(best_mutex_);
+    return samples_ >= 3 ? best_limit_ : 0;
+}
+
+size_t ConcurrencyMemory::find(const std::string& device) const
+{
+    std::scoped_lock<std::mutex> lock(mutex_);
+    auto it = best_.find(device);
+    return it != best_.end() ? it->second : 0;
+}
+
+void ConcurrencyMemory::store(const std::string& device, size_t workers)
+{
+    if (device.empty() || workers == 0) {
+        return;
+    }
+    std::scoped_lock<std::mutex> lock(mutex_);
+    best_[device] = workers;
+}
+
+bool ConcurrencyMemory::load(const std::filesystem::path& file)
+{
+    std::ifstream in(file);
+    if (!in) {
+        return false;
+    }
+    std::map<std::string, size_t> loaded;
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t tab = line.rfind('\t');
+        if (tab == std::string::npos || tab == 0) {
+            continue;
+        }
+        try {
+            loaded[line.substr(0, tab)] = std::stoul(line.substr(tab + 1));
+        } catch (const std::exception&) {
+            // riga corrotta: ignorata
+        }
+    }
+    std::scoped_lock<std::mutex> lock(mutex_);
+    for (const auto& [device, workers] : loaded) {
+        best_.emplace(device, workers); // quelli misurati in questa sessione vincono
+    }
+    return true;
+}
+
+bool ConcurrencyMemory::save(const std::filesystem::path& file) const
+{
+    std::error_code ec;
+    std::filesystem::create_directories(file.parent_path(), ec);
+    std::filesystem::path tmp = file;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        std::scoped_lock<std::mutex> lock(mutex_);
+        for (const auto& [device, workers] : best_) {
+            out << device << '\t' << workers << '\n';
+        }
+        if (!out) {
+            return false;
+        }
+    }
+    std::filesystem::rename(tmp, file, ec);
+    return !ec;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+
+// Numero di worker attivi scelto a runtime guardando il throughput.
+//
+// I worker partono tutti, ma lavorano solo limit() alla volta: ogni blocco
+// di lavoro sta tra enter() e leave(), e i posti sono comuni a tutti i
+// parallel_for della ricerca (root e device scanditi in parallelo), così il
+// limite è quello dei lettori concorrenti davvero. Ogni campione (byte e file fatti finora) confronta il
+// throughput dell'ultimo intervallo con il precedente: se migliora si continua
+// nella stessa direzione, se peggiora si torna indietro, a parità si
+// preferiscono meno thread. Su NVMe sale verso il massimo, su HDD e share
+// di rete si ferma dove la contesa comincia a costare.
+class ConcurrencyTuner
+{
+public:
+    ConcurrencyTuner(size_t max_workers, size_t initial);
+
+    size_t limit() const { return limit_.load(std::memory_order_relaxed); }
+    size_t max_workers() const { return max_; }
+
+    // Worker: aspetta un posto libero prima di un blocco di lavoro. done()
+    // dice quando smettere di aspettare (lavoro finito, stop): è un predicato
+    // esterno, chi lo fa diventare vero chiama wake(). false se done() è
+    // vero: il posto non è stato preso e non va lasciato.
+    template <typename Done>
+    bool enter(Done done)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // wait_for: lo stop della ricerca non chiama wake()
+        while (active_ >= limit() && !released_ && !done()) {
+            turn_.wait_for(lock, std::chrono::milliseconds(50));
+        }
+        if (done()) {
+            return false;
+        }
+        ++active_;
+        return true;
+    }
+
+    // Fine del blocco: il posto passa a un worker parcheggiato
+    void leave();
+
+    // Fa ricontrollare done() ai worker parcheggiati
+    void wake();
+
+    // Controller: contatori cumulativi della ricerca, chiamato a intervalli regolari
+    void sample(uint64_t bytes_done, uint64_t files_done);
+
+    // Sveglia i worker parcheggiati (fine ricerca)
+    void release();
+
+    // Il limite col throughput migliore visto; 0 se i campioni non bastano
+    size_t best() const;
+
+private:
+    void set_limit(size_t limit);
+
+    const size_t max_;
+    std::atomic<size_t> limit_;
+    std::atomic<bool> released_{false};
+    size_t active_ = 0; // posti presi, sotto mutex_
+    std::mutex mutex_;
+    std::condition_variable turn_;
+
+    // Stato del controller (solo il thread che chiama sample)
+    std::chrono::steady_clock::time_point last_time_ = std::chrono::steady_clock::now();
+    uint64_t last_bytes_ = 0;
+    uint64_t last_files_ = 0;
+    double last_rate_ = 0.0;
+    int direction_ = -1; // si parte provando a scendere
+    size_t samples_ = 0;
+    mutable std::mutex best_mutex_;
+    size_t best_limit_ = 0;
+    double best_rate_ = 0.0;
+};
+
+// Limite migliore per volume, tra una ricerca e l'altra. Salvato in un file
+// di testo ("<device>\t<thread>" per riga) nella directory degli snapshot.
+class ConcurrencyMemory
+{
+public:
+    size_t find(const std::string &device) const; // 0 = mai visto
+    void store(const std::string &device, size_t workers);
+
+    bool load(const std::filesystem::path &file);
+    bool save(const std::filesystem::path &file) const;
+
+private:
+    mutable std::mutex mutex_;
+    std::map<std::string, size_t> best_;
+};
@@ -0,0 +1,83 @@
+#include "ContentCache.h"
+
+void ContentCache::set_budget(size_t bytes)
+{
+    std::scoped_lock<std::mutex> lock(mutex_);
+    budget_ = bytes;
+    evict_to(budget_);
+}
+
+size_t ContentCache::budget() const
+{
+    std::scoped_lock<std::mutex> lock(mutex_);
+    return budget_;
+}
+
+std::shared_ptr<const ContentCache::Content> ContentCache::find(PathView path, uint64_t size, int64_t mtime)
+{
+    std::scoped_lock<std::mutex> lock(mutex_);
+    auto it = index_.find(path);
+    if (it == index_.end()) {
+        return nullptr;
+    }
+    auto entry = it->second;
+    if (entry->size != size || entry->mtime != mtime) {
+        // file cambiato: la copia in cache non vale più
+        used_ -= entry->content->bytes.size();
+        index_.erase(it);
+        lru_.erase(entry);
+        return nullptr;
+    }
+    lru_.splice(lru_.begin(), lru_, entry);
+    return entry->content;
+}
+
+void ContentCache::insert(PathView path, uint64_t size, int64_t mtime,
+                          const char* data, size_t length, uint64_t hash)
+{
+    {
+        std::scoped_lock<std::mutex> lock(mutex_);
+        if (length > budget_ / kMaxEntryShare) {
+            return;
+        }
+    }
+
+    // Copia fuori dal lock: è la parte costosa
+    auto content = std::make_shared<Content>();
+    content->bytes.assign(data, length);
+    content->hash = hash;
+
+    // Il budget può essere cambiato (set_budget) durante la copia: si
+    // ricontrolla, e la sottrazione non va sotto zero
+    std::scoped_lock<std::mutex> lock(mutex_);
+    if (length > budget_ / kMaxEntryShare || index_.count(path) != 0) {
+        return; // troppo grande per il budget attuale, o già inserito da un altro worker
+    }
+    evict_to(budget_ > length ? budget_ - length : 0);
+    lru_.push_front(Entry{std::filesystem::path::string_type(path), size, mtime, std::move(content)});
+    index_.emplace(lru_.front().key, lru_.begin());
+    used_ += length;
+}
+
+void ContentCache::clear()
+{
+    std::scoped_lock<std::mutex> lock(mutex_);
+    evict_to(0);
+}
+
+size_t ContentCache::used_bytes() const
+{
+    std::scoped_lock<std::mutex> lock(mutex_);
+    return used_;
+}
+
+// Chiamante: mutex_ già acquisito. Chi sta ancora leggendo un contenuto
+// evitto lo tiene vivo tramite shared_ptr.
+void ContentCache::evict_to(size_t target)
+{
+    while (used_ > target && !lru_.empty()) {
+        used_ -= lru_.back().content->bytes.size();
+        index_.erase(lru_.back().key);
+        lru_.pop_back();
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Cache LRU del contenuto dei file scanditi di recente, con budget in byte.
+//
+// Pensata per query diverse ripetute sugli stessi file quando la page cache
+// non basta (dischi di rete): un file in cache viene cercato direttamente
+// in memoria, senza open/mmap. Valida finché size e mtime non cambiano.
+class ContentCache
+{
+public:
+    struct Content
+    {
+        std::string bytes;
+        uint64_t    hash = 0; // content_hash dei byte, per il dedup
+    };
+
+    // budget == 0: cache disabilitata (e svuotata)
+    void set_budget(size_t bytes);
+    size_t budget() const;
+    bool enabled() const { return budget() > 0; }
+
+    // Un file più grande di così non entra: occuperebbe troppo budget da solo
+    static constexpr size_t kMaxEntryShare = 16; // frazione del budget
+    size_t max_entry_size() const { return budget() / kMaxEntryShare; }
+
+    using PathView = std::basic_string_view<std::filesystem::path::value_type>;
+
+    std::shared_ptr<const Content> find(PathView path, uint64_t size, int64_t mtime);
+    void insert(PathView path, uint64_t size, int64_t mtime,
+                const char *data, size_t length, uint64_t hash);
+    void clear();
+
+    size_t used_bytes() const;
+
+private:
+    struct Entry
+    {
+        std::filesystem::path::string_type key;
+        uint64_t size;
+        int64_t  mtime;
+        std::shared_ptr<const Content> content;
+    };
+
+    void evict_to(size_t target);
+
+    mutable std::mutex mutex_;
+    size_t budget_ = 0;
+    size_t used_ = 0;
+    std::list<Entry> lru_; // front = usato più di recente
+    // Chiavi: viste sul path della voce in lru_ (i nodi della lista non si spostano)
+    std::unordered_map<PathView, std::list<Entry>::iterator> index_;
+};
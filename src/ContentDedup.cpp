@@ -0,0 +1,170 @@
+#include "ContentDedup.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline uint64_t read64(const char *p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+inline uint32_t read32(const char *p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+inline uint64_t xxh_round(uint64_t acc, uint64_t input)
+{
+    acc += input * kPrime2;
+    acc = rotl(acc, 31);
+    return acc * kPrime1;
+}
+
+inline uint64_t merge_round(uint64_t acc, uint64_t val)
+{
+    acc ^= xxh_round(0, val);
+    return acc * kPrime1 + kPrime4;
+}
+} // namespace
+
+uint64_t content_hash(const char* data, size_t size)
+{
+    const char* p = data;
+    const char* const end = data + size;
+    uint64_t h;
+
+    if (size >= 32) {
+        uint64_t v1 = kPrime1 + kPrime2, v2 = kPrime2, v3 = 0, v4 = 0 - kPrime1;
+        const char* const limit = end - 32;
+        do {
+            v1 = xxh_round(v1, read64(p));
+            v2 = xxh_round(v2, read64(p + 8));
+            v3 = xxh_round(v3, read64(p + 16));
+            v4 = xxh_round(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = merge_round(h, v1);
+        h = merge_round(h, v2);
+        h = merge_round(h, v3);
+        h = merge_round(h, v4);
+    } else {
+        h = kPrime5;
+    }
+
+    h += static_cast<uint64_t>(size);
+
+    while (p + 8 <= end) {
+        h ^= xxh_round(0, read64(p));
+        h = rotl(h, 27) * kPrime1 + kPrime4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<uint64_t>(read32(p)) * kPrime1;
+        h = rotl(h, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    while (p < end) {
+        h ^= static_cast<uint64_t>(static_cast<unsigned char>(*p)) * kPrime5;
+        h = rotl(h, 11) * kPrime1;
+        ++p;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+static uint64_t path_key(PathView path)
+{
+    return std::hash<PathView>{}(path);
+}
+
+bool ContentHashCache::lookup(PathView path, uint64_t size, int64_t mtime, uint64_t& hash) const
+{
+    const uint64_t key = path_key(path);
+    std::scoped_lock<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end() || it->second.size != size || it->second.mtime != mtime) {
+        return false;
+    }
+    hash = it->second.hash;
+    return true;
+}
+
+void ContentHashCache::store(PathView path, uint64_t size, int64_t mtime, uint64_t hash)
+{
+    const uint64_t key = path_key(path);
+    std::scoped_lock<std::mutex> lock(mutex_);
+    entries_.insert_or_assign(key, Entry{size, mtime, hash});
+}
+
+void ContentHashCache::clear()
+{
+    std::scoped_lock<std::mutex> lock(mutex_);
+    entries_.clear();
+}
+
+DedupTable::Claim DedupTable::claim(uint64_t key, const ScannedFile* waiter, ContentVerdict& done_verdict)
+{
+    std::scoped_lock<std::mutex> lock(mutex_);
+    auto [it, inserted] = slots_.try_emplace(key);
+    if (inserted) {
+        return Claim::Owner;
+    }
+    if (it->second.done) {
+        done_verdict = it->second.verdict;
+        return Claim::Done;
+    }
+    if (waiter != nullptr) {
+        // Il path del chiamante è nel suo buffer, riusato per il file dopo
+        using Char = PathView::value_type;
+        Char* copy = static_cast<Char*>(resource_->allocate((waiter->path.size() + 1) * sizeof(Char), alignof(Char)));
+        std::copy(waiter->path.begin(), waiter->path.end(), copy);
+        copy[waiter->path.size()] = Char(0);
+        it->second.waiters.push_back(ScannedFile{PathView(copy, waiter->path.size()), waiter->size, waiter->mtime});
+    }
+    return Claim::Waiting;
+}
+
+std::vector<ScannedFile> DedupTable::publish(uint64_t key, const ContentVerdict& verdict)
+{
+    std::scoped_lock<std::mutex> lock(mutex_);
+    Slot& slot = slots_[key];
+    slot.done = true;
+    slot.verdict = verdict;
+    return std::move(slot.waiters);
+}
+
+void DedupTable::publish_if_absent(uint64_t key, const ContentVerdict& verdict)
+{
+    std::scoped_lock<std::mutex> lock(mutex_);
+    auto [it, inserted] = slots_.try_emplace(key);
+    if (inserted) {
+        it->second.done = true;
+        it->second.verdict = verdict;
+    }
+}
+
+void DedupTable::clear()
+{
+    std::scoped_lock<std::mutex> lock(mutex_);
+    slots_.clear();
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory_resource>
+#include <mutex>
+#include <string_view>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Hash del contenuto (XXH64): identifica copie byte-identiche dello stesso asset
+uint64_t content_hash(const char *data, size_t size);
+
+// Esito della scansione di un contenuto per il pattern corrente: vale per
+// tutte le copie identiche, cambia solo il path (e quindi il punteggio sul nome)
+struct ContentVerdict
+{
+    size_t count = 0;
+    size_t header_count = 0;
+    size_t edit_distance = 0; // ricerca approssimata
+};
+
+// Path nativo senza copia, terminato da '\0' (si apre con path.data())
+using PathView = std::basic_string_view<std::filesystem::path::value_type>;
+
+// Un file da riportare come risultato: path e metadati mostrati nella
+// tabella. Il path sta in un buffer riusato dal worker mentre il file si
+// scandisce; le copie in coda su un verdetto lo copiano nell'arena della
+// ricerca (DedupTable). Diventa una stringa sull'heap solo nel SearchResult.
+struct ScannedFile
+{
+    PathView path;
+    uint64_t size = 0;
+    int64_t  mtime = 0; // unità native del walk (vedi FileEntry)
+};
+
+// Hash dei file già letti, valido finché size e mtime non cambiano.
+// Sopravvive tra una ricerca e l'altra. La chiave è un hash a 64 bit del
+// path: nessuna copia del path per file; una collisione dovrebbe avere
+// anche size e mtime uguali.
+class ContentHashCache
+{
+public:
+    bool lookup(PathView path, uint64_t size, int64_t mtime, uint64_t &hash) const;
+    void store(PathView path, uint64_t size, int64_t mtime, uint64_t hash);
+    void clear();
+
+private:
+    struct Entry
+    {
+        uint64_t size;
+        int64_t  mtime;
+        uint64_t hash;
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_map<uint64_t, Entry> entries_;
+};
+
+// Verdetti di una singola ricerca, per chiave (inode o hash del contenuto).
+// Il primo file che reclama una chiave la scandisce; chi arriva mentre la
+// scansione è in corso si mette in coda e riceve il verdetto dall'owner.
+class DedupTable
+{
+public:
+    enum class Claim { Owner, Waiting, Done };
+
+    // resource: memoria della ricerca, per i path dei file in coda
+    explicit DedupTable(std::pmr::memory_resource *resource) : resource_(resource) {}
+
+    // waiter == nullptr: non accodarsi (Waiting ritorna senza registrare nulla)
+    Claim claim(uint64_t key, const ScannedFile *waiter, ContentVerdict &done_verdict);
+
+    // Pubblica il verdetto dell'owner e ritorna i file rimasti in coda
+    std::vector<ScannedFile> publish(uint64_t key, const ContentVerdict &verdict);
+
+    // Registra un verdetto per una chiave non ancora vista (nessuna coda)
+    void publish_if_absent(uint64_t key, const ContentVerdict &verdict);
+
+    void clear();
+
+private:
+    struct Slot
+    {
+        bool done = false;
+        ContentVerdict verdict;
+        std::vector<ScannedFile> waiters;
+    };
+
+    std::pmr::memory_resource *resource_;
+    std::mutex mutex_;
+    std::unordered_map<uint64_t, Slot> slots_;
+};
@@ -0,0 +1,123 @@
+#include "DiskLayout.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <winioctl.h>
+#else
+#include <sys/stat.h>
+#endif
+#if defined(__linux__)
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace DiskLayout
+{
+#ifdef _WIN32
+uint64_t physical_offset(const std::filesystem::path &path)
+{
+    // Basta FILE_READ_ATTRIBUTES: niente lettura del contenuto
+    HANDLE file = CreateFileW(path.c_str(), FILE_READ_ATTRIBUTES,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, 0, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+    STARTING_VCN_INPUT_BUFFER input = {};
+    RETRIEVAL_POINTERS_BUFFER output = {}; // spazio per il solo primo extent
+    DWORD returned = 0;
+    const BOOL ok = DeviceIoControl(file, FSCTL_GET_RETRIEVAL_POINTERS, &input, sizeof(input),
+                                    &output, sizeof(output), &returned, nullptr);
+    CloseHandle(file);
+    // ERROR_MORE_DATA: più extent, il primo c'è comunque
+    if ((!ok && GetLastError() != ERROR_MORE_DATA) || output.ExtentCount == 0 ||
+        output.Extents[0].Lcn.QuadPart < 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>(output.Extents[0].Lcn.QuadPart);
+}
+#elif defined(__linux__)
+uint64_t physical_offset(const std::filesystem::path &path)
+{
+    // O_NOATIME è permesso solo sui propri file: altrimenti open normale
+    int fd = ::open(path.c_str(), O_RDONLY | O_NOATIME);
+    if (fd < 0) {
+        fd = ::open(path.c_str(), O_RDONLY);
+    }
+    if (fd < 0) {
+        return 0;
+    }
+    // fiemap seguita dallo spazio per un solo extent
+    alignas(fiemap) unsigned char buffer[sizeof(fiemap) + sizeof(fiemap_extent)] = {};
+    fiemap *map = reinterpret_cast<fiemap *>(buffer);
+    map->fm_start = 0;
+    map->fm_length = FIEMAP_MAX_OFFSET;
+    map->fm_extent_count = 1;
+    const bool ok = ::ioctl(fd, FS_IOC_FIEMAP, map) == 0;
+    ::close(fd);
+    if (!ok || map->fm_mapped_extents == 0 ||
+        (map->fm_extents[0].fe_flags & (FIEMAP_EXTENT_UNKNOWN | FIEMAP_EXTENT_DATA_INLINE))) {
+        return 0;
+    }
+    return map->fm_extents[0].fe_physical;
+}
+#else
+uint64_t physical_offset(const std::filesystem::path &)
+{
+    return 0;
+}
+#endif
+
+#ifdef _WIN32
+std::string device_key(const std::filesystem::path &path)
+{
+    wchar_t volume[MAX_PATH];
+    if (!GetVolumePathNameW(std::filesystem::absolute(path).c_str(), volume, MAX_PATH)) {
+        return {};
+    }
+    return std::filesystem::path(volume).string();
+}
+#else
+std::string device_key(const std::filesystem::path &path)
+{
+    struct stat sb;
+    if (::stat(path.c_str(), &sb) != 0) {
+        return {};
+    }
+    return "dev:" + std::to_string(static_cast<uint64_t>(sb.st_dev));
+}
+#endif
+
+void DeviceSlots::set_limit(size_t per_device)
+{
+    std::scoped_lock<std::mutex> lock(mutex_);
+    limit_ = per_device > 0 ? per_device : 1;
+    freed_.notify_all();
+}
+
+void DeviceSlots::acquire(uint64_t device)
+{
+    // Nessuno stop qui: chi tiene lo slot lo controlla durante la lettura
+    // e lo rende presto
+    std::unique_lock<std::mutex> lock(mutex_);
+    size_t &busy = busy_[device];
+    freed_.wait(lock, [&]() { return busy < limit_; });
+    ++busy;
+}
+
+void DeviceSlots::release(uint64_t device)
+{
+    {
+        // Le voci restano (pochi device): chi aspetta tiene un riferimento
+        std::scoped_lock<std::mutex> lock(mutex_);
+        --busy_[device];
+    }
+    freed_.notify_all();
+}
+}
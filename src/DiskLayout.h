@@ -0,0 +1,57 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Dove stanno i file: posizione fisica sul disco, per leggerli nell'ordine
+// in cui stanno sui piatti (HDD, share di rete su HDD) invece che in ordine
+// di walk, e volume di appartenenza.
+namespace DiskLayout
+{
+// Offset (o cluster) fisico del primo extent del file: FIEMAP su Linux,
+// FSCTL_GET_RETRIEVAL_POINTERS su Windows. Ha senso solo per confrontare
+// file dello stesso volume. 0 = sconosciuto (filesystem senza supporto,
+// file vuoto o tenuto inline nei metadati).
+uint64_t physical_offset(const std::filesystem::path &path);
+
+// Identifica il volume che contiene path, stabile tra un avvio e l'altro:
+// "dev:<st_dev>" su POSIX, la root del volume su Windows (es. D:\ o
+// \\server\share\). Vuoto se il path non esiste.
+std::string device_key(const std::filesystem::path &path);
+
+// Letture concorrenti per device (st_dev), condivise da tutte le root di una
+// ricerca: due root sullo stesso disco non raddoppiano i lettori, e quindi
+// i seek. Un slot si tiene per la lettura di un file intero.
+class DeviceSlots
+{
+public:
+    void set_limit(size_t per_device);
+
+    void acquire(uint64_t device);
+    void release(uint64_t device);
+
+    class Guard
+    {
+    public:
+        Guard(DeviceSlots &slots, uint64_t device) : slots_(slots), device_(device) { slots_.acquire(device_); }
+        ~Guard() { slots_.release(device_); }
+
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+
+    private:
+        DeviceSlots &slots_;
+        uint64_t device_;
+    };
+
+private:
+    std::mutex mutex_;
+    std::condition_variable freed_;
+    size_t limit_ = 2;
+    std::unordered_map<uint64_t, size_t> busy_;
+};
+}
@@ -0,0 +1,185 @@
+#include "FileFilter.h"
+#include <algorithm>
+
+static inline char fold(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+}
+
+static std::string fold_copy(std::string_view s)
+{
+    std::string out(s);
+    std::transform(out.begin(), out.end(), out.begin(), fold);
+    return out;
+}
+
+static bool equal_folded(std::string_view a, std::string_view folded)
+{
+    if (a.size() != folded.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (fold(a[i]) != folded[i]) return false;
+    }
+    return true;
+}
+
+static bool contains_folded(std::string_view hay, std::string_view folded)
+{
+    if (folded.size() > hay.size()) return false;
+    for (size_t i = 0; i + folded.size() <= hay.size(); ++i) {
+        if (equal_folded(hay.substr(i, folded.size()), folded)) return true;
+    }
+    return false;
+}
+
+// Glob con '*', '?' (non attraversano '/') e '**' (qualsiasi profondità).
+// pattern già in minuscolo.
+static bool glob_match(std::string_view s, std::string_view p)
+{
+    while (!p.empty()) {
+        if (p.substr(0, 2) == "**") {
+            p.remove_prefix(2);
+            // "**/" può anche non consumare nessuna directory
+            if (!p.empty() && p.front() == '/' && glob_match(s, p.substr(1))) return true;
+            for (size_t i = 0; i <= s.size(); ++i) {
+                if (glob_match(s.substr(i), p)) return true;
+            }
+            return false;
+        }
+        if (p.front() == '*') {
+            p.remove_prefix(1);
+            for (size_t i = 0;; ++i) {
+                if (glob_match(s.substr(i), p)) return true;
+                if (i >= s.size() || s[i] == '/') return false;
+            }
+        }
+        if (s.empty()) return false;
+        if (p.front() == '?') {
+            if (s.front() == '/') return false;
+        } else if (fold(s.front()) != p.front()) {
+            return false;
+        }
+        s.remove_prefix(1);
+        p.remove_prefix(1);
+    }
+    return s.empty();
+}
+
+static std::vector<std::string> split_list(const std::string& list)
+{
+    std::vector<std::string> items;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find_first_of(";,", start);
+        if (end == std::string::npos) end = list.size();
+        std::string item = list.substr(start, end - start);
+        item.erase(0, item.find_first_not_of(" \t"));
+        item.erase(item.find_last_not_of(" \t") + 1);
+        std::replace(item.begin(), item.end(), '\\', '/');
+        while (!item.empty() && item.back() == '/') item.pop_back(); // "Developers/" = "Developers"
+        if (!item.empty()) items.push_back(std::move(item));
+        start = end + 1;
+    }
+    return items;
+}
+
+FileFilter::Glob FileFilter::compile_glob(std::string_view pattern)
+{
+    Glob glob;
+    glob.text = fold_copy(pattern);
+    glob.on_path = glob.text.find('/') != std::string::npos;
+
+    const std::string& t = glob.text;
+    const size_t wildcards = std::count(t.begin(), t.end(), '*') + std::count(t.begin(), t.end(), '?');
+    const size_t stars = std::count(t.begin(), t.end(), '*');
+
+    // I casi comuni ("Developers", "*.uexp", "BP_*", "*Test*") diventano
+    // confronti diretti, senza passare dal matcher generico.
+    if (glob.on_path || wildcards != stars) {
+        glob.kind = wildcards == 0 ? Glob::Kind::Exact : Glob::Kind::Pattern;
+    } else if (stars == 0) {
+        glob.kind = Glob::Kind::Exact;
+    } else if (stars == 1 && t.front() == '*' && t.size() > 1) {
+        glob.kind = Glob::Kind::Suffix;
+        glob.text.erase(0, 1);
+    } else if (stars == 1 && t.back() == '*' && t.size() > 1) {
+        glob.kind = Glob::Kind::Prefix;
+        glob.text.pop_back();
+    } else if (stars == 2 && t.size() > 2 && t.front() == '*' && t.back() == '*') {
+        glob.kind = Glob::Kind::Contains;
+        glob.text = glob.text.substr(1, glob.text.size() - 2);
+    } else {
+        glob.kind = Glob::Kind::Pattern;
+    }
+    return glob;
+}
+
+FileFilter FileFilter::compile(const std::string& include,
+                               const std::string& exclude,
+                               const std::string& extensions)
+{
+    FileFilter filter;
+    for (const auto& item : split_list(include)) filter.include_.push_back(compile_glob(item));
+    for (const auto& item : split_list(exclude)) filter.exclude_.push_back(compile_glob(item));
+    for (auto item : split_list(extensions)) {
+        item = fold_copy(item);
+        if (item.front() == '*') item.erase(0, 1);   // "*.uasset"
+        if (item.empty()) continue;
+        if (item.front() != '.') item = "." + item;     // "uasset"
+        filter.extensions_.push_back(std::move(item));
+    }
+
+    auto uses_path = [](const std::vector<Glob>& globs) {
+        return std::any_of(globs.begin(), globs.end(), [](const Glob& g) { return g.on_path; });
+    };
+    filter.needs_relative_path_ = uses_path(filter.include_) || uses_path(filter.exclude_);
+
+    filter.signature_ = include + "|" + exclude + "|" + extensions;
+    return filter;
+}
+
+bool FileFilter::matches(const Glob& glob, std::string_view name, std::string_view relative_path)
+{
+    const std::string_view subject = glob.on_path ? relative_path : name;
+    const std::string_view t = glob.text;
+    switch (glob.kind) {
+        case Glob::Kind::Exact:
+            return equal_folded(subject, t);
+        case Glob::Kind::Prefix:
+            return subject.size() >= t.size() && equal_folded(subject.substr(0, t.size()), t);
+        case Glob::Kind::Suffix:
+            return subject.size() >= t.size() && equal_folded(subject.substr(subject.size() - t.size()), t);
+        case Glob::Kind::Contains:
+            return contains_folded(subject, t);
+        case Glob::Kind::Pattern:
+            return glob_match(subject, t);
+    }
+    return false;
+}
+
+bool FileFilter::matches_any(const std::vector<Glob>& globs, std::string_view name, std::string_view relative_path)
+{
+    for (const auto& glob : globs) {
+        if (matches(glob, name, relative_path)) return true;
+    }
+    return false;
+}
+
+bool FileFilter::prune_directory(std::string_view name, std::string_view relative_path) const
+{
+    return matches_any(exclude_, name, relative_path);
+}
+
+bool FileFilter::accept_file(std::string_view name, std::string_view relative_path) const
+{
+    if (!extensions_.empty()) {
+        const size_t dot = name.find_last_of('.');
+        if (dot == std::string_view::npos) return false;
+        const std::string_view ext = name.substr(dot);
+        if (std::none_of(extensions_.begin(), extensions_.end(),
+                         [&](const std::string& e) { return equal_folded(ext, e); })) {
+            return false;
+        }
+    }
+    if (matches_any(exclude_, name, relative_path)) return false;
+    return include_.empty() || matches_any(include_, name, relative_path);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Regole di inclusione/esclusione applicate durante il walk.
+//
+// Le liste sono separate da ';' o ',' e compilate una volta per ricerca:
+//   include    "Weapons/**;BP_*"      se non vuota, il file deve matcharne almeno una
+//   exclude    "Developers;*.uexp"    file e directory esclusi (una directory
+//                                     esclusa non viene nemmeno visitata)
+//   extensions ".uasset;.umap"        allow-list delle estensioni
+//
+// Un glob senza '/' si applica al solo nome, uno con '/' al path relativo
+// alla root di ricerca (separatore '/'). '*' e '?' non attraversano '/',
+// '**' sì. Tutto case-insensitive.
+class FileFilter
+{
+public:
+    // Default di GUI e riga di comando: i .uexp/.ubulk contengono solo dati
+    // di export, i nomi referenziati stanno tutti nell'header del .uasset
+    static constexpr const char *kDefaultExtensions = ".uasset;.umap";
+    static constexpr const char *kDefaultExclude    = "Developers;Collections";
+
+    FileFilter() = default; // accetta tutto
+
+    static FileFilter compile(const std::string &include,
+                              const std::string &exclude,
+                              const std::string &extensions);
+
+    bool empty() const { return include_.empty() && exclude_.empty() && extensions_.empty(); }
+
+    // Testo delle regole: due filtri con la stessa firma sono equivalenti
+    const std::string &signature() const { return signature_; }
+
+    // Richiede il path relativo (e non solo il nome) per decidere?
+    bool needs_relative_path() const { return needs_relative_path_; }
+
+    // true = non scendere nella directory
+    bool prune_directory(std::string_view name, std::string_view relative_path) const;
+
+    // Nome e path relativo così come arrivano dal walk: il folding è interno
+    bool accept_file(std::string_view name, std::string_view relative_path) const;
+
+private:
+    struct Glob
+    {
+        enum class Kind { Exact, Prefix, Suffix, Contains, Pattern };
+        Kind        kind = Kind::Pattern;
+        bool        on_path = false; // confronta col path relativo invece che col nome
+        std::string text;            // minuscolo; per Prefix/Suffix/Contains senza '*'
+    };
+
+    static Glob compile_glob(std::string_view pattern);
+    static bool matches(const Glob &glob, std::string_view name, std::string_view relative_path);
+    static bool matches_any(const std::vector<Glob> &globs, std::string_view name, std::string_view relative_path);
+
+    std::vector<Glob>        include_;
+    std::vector<Glob>        exclude_;
+    std::vector<std::string> extensions_; // minuscolo, con il punto
+    std::string              signature_;
+    bool                     needs_relative_path_ = false;
+};
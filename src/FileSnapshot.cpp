@@ -0,0 +1,209 @@
+#include "FileSnapshot.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+constexpr char     kMagic[8] = {'S', 'A', 'S', 'N', 'A', 'P', '\0', '\0'};
+constexpr uint32_t kVersion  = 1;
+
+struct Header
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t root_hash;    // la stessa cache non va riusata per un'altra root
+    uint64_t entry_count;
+    uint64_t blob_size;
+};
+
+struct Record
+{
+    uint64_t size;
+    int64_t  mtime;
+    uint64_t inode;
+    uint64_t device;
+    uint32_t path_offset;  // nel blob
+    uint32_t path_length;
+};
+
+uint64_t fnv1a(const std::string &s, uint64_t h = 1469598103934665603ull)
+{
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+unsigned long process_id()
+{
+#ifdef _WIN32
+    return static_cast<unsigned long>(_getpid());
+#else
+    return static_cast<unsigned long>(::getpid());
+#endif
+}
+
+std::string root_key(const std::filesystem::path &root)
+{
+    std::error_code ec;
+    auto absolute = std::filesystem::absolute(root, ec);
+    return (ec ? root : absolute).lexically_normal().generic_string();
+}
+
+// Path relativo nativo ('/' come separatore) → UTF-8 del blob, e ritorno.
+// Su POSIX il nativo è già UTF-8.
+#ifdef _WIN32
+std::string to_utf8(const FileTable::String &relative)
+{
+    auto u8 = std::filesystem::path(relative).generic_u8string();
+    return std::string(u8.begin(), u8.end());
+}
+
+FileTable::String from_utf8(std::string_view utf8)
+{
+    return std::filesystem::path(std::u8string(utf8.begin(), utf8.end())).generic_wstring();
+}
+#else
+const std::string &to_utf8(const std::string &relative)
+{
+    return relative;
+}
+
+std::string_view from_utf8(std::string_view utf8)
+{
+    return utf8;
+}
+#endif
+} // namespace
+
+std::filesystem::path FileSnapshot::file_for(const std::filesystem::path& snapshot_dir,
+                                             const std::filesystem::path& root,
+                                             const std::string& filter_signature)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.snap",
+             static_cast<unsigned long long>(fnv1a(filter_signature, fnv1a(root_key(root)))));
+    return snapshot_dir / name;
+}
+
+bool FileSnapshot::save(const std::filesystem::path& file,
+                        const std::filesystem::path& root,
+                        const FileTable& entries)
+{
+    std::vector<Record> records;
+    records.reserve(entries.size());
+    std::string blob;
+    FileTable::String relative;
+
+    for (const FileEntry& entry : entries) {
+        relative.clear();
+        entries.append_relative(entry, relative);
+        const auto& utf8 = to_utf8(relative);
+        Record record{entry.size, entry.mtime, entry.inode, entry.device,
+                      static_cast<uint32_t>(blob.size()), static_cast<uint32_t>(utf8.size())};
+        records.push_back(record);
+        blob += utf8;
+    }
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.record_size = sizeof(Record);
+    header.root_hash = fnv1a(root_key(root));
+    header.entry_count = records.size();
+    header.blob_size = blob.size();
+
+    // Scrittura su file temporaneo + rename: un crash non lascia snapshot a
+    // metà. Nome univoco per processo e chiamata, così due processi che
+    // salvano la stessa root non scrivono nello stesso file.
+    std::error_code ec;
+    std::filesystem::create_directories(file.parent_path(), ec);
+    std::filesystem::path tmp = file;
+    tmp += "." + std::to_string(process_id()) + "-" + std::to_string(std::random_device{}()) + ".tmp";
+    bool written = false;
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (out) {
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(records.data()),
+                      static_cast<std::streamsize>(records.size() * sizeof(Record)));
+            out.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+            written = static_cast<bool>(out);
+        }
+    }
+    if (written) {
+        std::filesystem::rename(tmp, file, ec);
+    }
+    if (!written || ec) {
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+bool FileSnapshot::load(const std::filesystem::path& file,
+                        const std::filesystem::path& root,
+                        FileTable& out)
+{
+    MappedFile mapped;
+    if (!mapped.open(file) || mapped.size() < sizeof(Header)) {
+        return false;
+    }
+
+    Header header;
+    std::memcpy(&header, mapped.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+        header.version != kVersion ||
+        header.record_size != sizeof(Record) ||
+        header.root_hash != fnv1a(root_key(root))) {
+        return false;
+    }
+
+    // Conti fatti sulla size del file, senza moltiplicare valori dell'header
+    // che potrebbero traboccare
+    const uint64_t payload = mapped.size() - sizeof(Header);
+    if (header.entry_count > payload / sizeof(Record)) {
+        return false;
+    }
+    const uint64_t records_bytes = header.entry_count * sizeof(Record);
+    if (header.blob_size != payload - records_bytes) {
+        return false;
+    }
+
+    const char* records = mapped.data() + sizeof(Header);
+    const char* blob = records + records_bytes;
+
+    FileTable table(root);
+    table.reserve(header.entry_count);
+    for (uint64_t i = 0; i < header.entry_count; ++i) {
+        Record record;
+        std::memcpy(&record, records + i * sizeof(Record), sizeof(Record));
+        if (static_cast<uint64_t>(record.path_offset) + record.path_length > header.blob_size) {
+            return false;
+        }
+        const auto relative = from_utf8(std::string_view(blob + record.path_offset, record.path_length));
+        const FileTable::StringView view(relative);
+        const size_t slash = view.rfind('/');
+        const uint32_t dir = slash == FileTable::StringView::npos ? FileTable::kRoot
+                                                                  : table.directory_for(view.substr(0, slash));
+        FileEntry& entry = table.add_file(dir, slash == FileTable::StringView::npos ? view : view.substr(slash + 1));
+        entry.size = record.size;
+        entry.mtime = record.mtime;
+        entry.inode = record.inode;
+        entry.device = record.device;
+    }
+    out = std::move(table);
+    return true;
+}
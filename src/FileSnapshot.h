@@ -0,0 +1,33 @@
+#pragma once
+
+#include "FileTable.h"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Snapshot su disco della lista file di una root (path, size, mtime, inode).
+//
+// Salvato dopo ogni walk completo e ricaricato con mmap alla ricerca
+// successiva: la scansione parte subito sulla lista salvata mentre un walk
+// in background la valida e la aggiorna.
+//
+// Formato (endianness nativa, è una cache locale):
+//   Header | Record[entry_count] | blob dei path relativi (UTF-8)
+class FileSnapshot
+{
+public:
+    // File di snapshot per una root + regole del walk
+    static std::filesystem::path file_for(const std::filesystem::path &snapshot_dir,
+                                          const std::filesystem::path &root,
+                                          const std::string &filter_signature);
+
+    static bool save(const std::filesystem::path &file,
+                     const std::filesystem::path &root,
+                     const FileTable &entries);
+
+    // false se manca, è di un'altra versione/root o è corrotto.
+    // out deve essere una FileTable vuota con la stessa root.
+    static bool load(const std::filesystem::path &file,
+                     const std::filesystem::path &root,
+                     FileTable &out);
+};
@@ -0,0 +1,127 @@
+#include "FileTable.h"
+
+static constexpr FileTable::Char kSeparator = std::filesystem::path::preferred_separator;
+
+static bool ends_with_separator(const FileTable::String& s)
+{
+    return !s.empty() && (s.back() == kSeparator || s.back() == '/');
+}
+
+FileTable::FileTable(const std::filesystem::path& root) : root_(root)
+{
+    dirs_.push_back(Directory{UINT32_MAX, 0});
+}
+
+void FileTable::reserve(size_t files)
+{
+    files_.reserve(files);
+    names_.reserve(files * 24); // nome medio di un asset, terminatore incluso
+}
+
+uint32_t FileTable::add_name(StringView name)
+{
+    const uint32_t offset = static_cast<uint32_t>(names_.size());
+    names_.append(name);
+    names_.push_back(Char(0));
+    return offset;
+}
+
+FileTable::StringView FileTable::name_at(uint32_t offset) const
+{
+    return StringView(names_.data() + offset); // fino al terminatore
+}
+
+uint32_t FileTable::add_directory(uint32_t parent, StringView name)
+{
+    dirs_.push_back(Directory{parent, add_name(name)});
+    return static_cast<uint32_t>(dirs_.size() - 1);
+}
+
+uint32_t FileTable::directory_for(StringView relative)
+{
+    if (relative.empty()) {
+        return kRoot;
+    }
+    if (relative == last_relative_) {
+        return last_dir_; // file della stessa directory uno dopo l'altro
+    }
+    last_relative_.assign(relative);
+    auto it = relative_ids_.find(last_relative_);
+    if (it != relative_ids_.end()) {
+        last_dir_ = it->second;
+        return last_dir_;
+    }
+    const size_t slash = relative.rfind('/');
+    const uint32_t parent = slash == StringView::npos ? kRoot : directory_for(relative.substr(0, slash));
+    const uint32_t id = add_directory(parent, slash == StringView::npos ? relative : relative.substr(slash + 1));
+    relative_ids_.emplace(String(relative), id);
+    last_relative_.assign(relative); // la ricorsione sui padri l'ha cambiata
+    last_dir_ = id;
+    return id;
+}
+
+FileEntry& FileTable::add_file(uint32_t dir, StringView name)
+{
+    FileEntry& file = files_.emplace_back();
+    file.dir = dir;
+    file.name = add_name(name);
+    return file;
+}
+
+void FileTable::append_directory(uint32_t dir, String& out) const
+{
+    if (dir == kRoot) {
+        out += root_.native();
+        return;
+    }
+    append_directory(dirs_[dir].parent, out);
+    if (!ends_with_separator(out)) {
+        out.push_back(kSeparator);
+    }
+    out += name_at(dirs_[dir].name);
+}
+
+void FileTable::append_path(const FileEntry& file, String& out) const
+{
+    append_directory(file.dir, out);
+    if (!ends_with_separator(out)) {
+        out.push_back(kSeparator);
+    }
+    out += name(file);
+}
+
+std::filesystem::path FileTable::path(const FileEntry& file) const
+{
+    String out;
+    append_path(file, out);
+    return std::filesystem::path(std::move(out));
+}
+
+std::filesystem::path FileTable::directory_path(uint32_t dir) const
+{
+    String out;
+    append_directory(dir, out);
+    return std::filesystem::path(std::move(out));
+}
+
+void FileTable::append_relative_directory(uint32_t dir, String& out) const
+{
+    if (dir == kRoot) {
+        return;
+    }
+    append_relative_directory(dirs_[dir].parent, out);
+    out += name_at(dirs_[dir].name);
+    out.push_back(Char('/'));
+}
+
+void FileTable::append_relative(const FileEntry& file, String& out) const
+{
+    append_relative_directory(file.dir, out);
+    out += name(file);
+}
+
+size_t FileTable::memory_usage() const
+{
+    return dirs_.capacity() * sizeof(Directory) + files_.capacity() * sizeof(FileEntry) +
+           names_.capacity() * sizeof(Char);
+}
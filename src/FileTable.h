@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Un file trovato dal walk. Il path non c'è: lo ricostruisce la FileTable
+// da directory e nome, solo quando serve (apertura, risultati).
+struct FileEntry
+{
+    uint32_t dir = 0;    // id della directory nella FileTable
+    uint32_t name = 0;   // offset del nome nel blob della FileTable
+    uint64_t size = 0;
+    int64_t  mtime = 0;  // unità native del filesystem, solo per confronti
+    uint64_t inode = 0;  // 0 = sconosciuto (Windows)
+    uint64_t device = 0;
+};
+
+// Lista compatta dei file di una root.
+//
+// Invece di un std::filesystem::path per file (una stringa sull'heap con
+// il path assoluto intero) tiene un albero di directory con l'id del
+// padre, un blob unico con tutti i nomi (file e directory, terminati da
+// '\0') e un array di FileEntry da 40 byte. Il path completo si ricostruisce
+// risalendo i padri. Gli array sono contigui: le scansioni in parallelo
+// si dividono gli indici senza toccare l'heap.
+class FileTable
+{
+public:
+    using Char = std::filesystem::path::value_type;
+    using String = std::filesystem::path::string_type;
+    using StringView = std::basic_string_view<Char>;
+
+    static constexpr uint32_t kRoot = 0;
+
+    explicit FileTable(const std::filesystem::path &root = {});
+
+    const std::filesystem::path &root() const { return root_; }
+
+    // Sottodirectory di parent; il walk le aggiunge prima del contenuto
+    uint32_t add_directory(uint32_t parent, StringView name);
+    // Directory per un path relativo con separatori '/', creata se manca
+    // (caricamento dello snapshot, dove i file arrivano per directory)
+    uint32_t directory_for(StringView relative);
+
+    FileEntry &add_file(uint32_t dir, StringView name);
+
+    size_t size() const { return files_.size(); }
+    bool empty() const { return files_.empty(); }
+    size_t directory_count() const { return dirs_.size(); }
+    void reserve(size_t files);
+
+    const FileEntry &operator[](size_t i) const { return files_[i]; }
+    std::vector<FileEntry>::const_iterator begin() const { return files_.begin(); }
+    std::vector<FileEntry>::const_iterator end() const { return files_.end(); }
+
+    StringView name(const FileEntry &file) const { return name_at(file.name); }
+    uint32_t parent(uint32_t dir) const { return dirs_[dir].parent; }
+
+    // Path completo (root inclusa) in coda a out; out si può riusare tra
+    // un file e l'altro senza allocare
+    void append_path(const FileEntry &file, String &out) const;
+    void append_directory(uint32_t dir, String &out) const;
+    std::filesystem::path path(const FileEntry &file) const;
+    std::filesystem::path directory_path(uint32_t dir) const;
+
+    // Path relativo alla root, separatori '/'; quello di una directory
+    // termina con '/' (vuoto per la root)
+    void append_relative(const FileEntry &file, String &out) const;
+    void append_relative_directory(uint32_t dir, String &out) const;
+
+    size_t memory_usage() const;
+
+private:
+    struct Directory
+    {
+        uint32_t parent;
+        uint32_t name; // offset nel blob; la root non ha nome
+    };
+
+    StringView name_at(uint32_t offset) const;
+    uint32_t add_name(StringView name);
+
+    std::filesystem::path root_;
+    std::vector<Directory> dirs_;
+    std::vector<FileEntry> files_;
+    String names_; // "Nome1\0Nome2\0..."
+
+    // directory_for: id per path relativo, più l'ultimo usato
+    std::unordered_map<String, uint32_t> relative_ids_;
+    String last_relative_;
+    uint32_t last_dir_ = kRoot;
+};
@@ -0,0 +1,148 @@
+#include "FuzzyMatch.h"
+#include <algorithm>
+#include <cctype>
+
+// Pesi di fzf (algo.go)
+static constexpr int kScoreMatch = 16;
+static constexpr int kScoreGapStart = -3;
+static constexpr int kScoreGapExtension = -1;
+static constexpr int kBonusBoundary = kScoreMatch / 2;
+static constexpr int kBonusNonWord = kScoreMatch / 2;
+static constexpr int kBonusCamel123 = kBonusBoundary + kScoreGapExtension;
+static constexpr int kBonusConsecutive = -(kScoreGapStart + kScoreGapExtension);
+static constexpr int kBonusFirstCharMultiplier = 2;
+
+enum class CharClass
+{
+    NonWord,
+    Lower,
+    Upper,
+    Number,
+};
+
+static CharClass class_of(char c)
+{
+    const unsigned char u = static_cast<unsigned char>(c);
+    if (u >= 'a' && u <= 'z') return CharClass::Lower;
+    if (u >= 'A' && u <= 'Z') return CharClass::Upper;
+    if (u >= '0' && u <= '9') return CharClass::Number;
+    return u >= 0x80 ? CharClass::Lower : CharClass::NonWord; // UTF-8: parte di una parola
+}
+
+// Bonus di un carattere dato quello che lo precede
+static int bonus_for(CharClass previous, CharClass current)
+{
+    if (previous == CharClass::NonWord && current != CharClass::NonWord) return kBonusBoundary;
+    if ((previous == CharClass::Lower && current == CharClass::Upper) ||
+        (previous != CharClass::Number && current == CharClass::Number))
+    {
+        return kBonusCamel123;
+    }
+    if (current == CharClass::NonWord) return kBonusNonWord;
+    return 0;
+}
+
+FuzzyPattern::FuzzyPattern(std::string_view pattern)
+{
+    for (char c : pattern)
+    {
+        if (c != ' ')
+        {
+            pattern_.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+        }
+    }
+    mask_ = char_mask(pattern_);
+}
+
+uint64_t FuzzyPattern::char_mask(std::string_view lower)
+{
+    // a-z → bit 0-25, 0-9 → 26-35, il resto sparso sui bit alti
+    uint64_t mask = 0;
+    for (char c : lower)
+    {
+        const unsigned char u = static_cast<unsigned char>(c);
+        unsigned bit;
+        if (u >= 'a' && u <= 'z') bit = u - 'a';
+        else if (u >= '0' && u <= '9') bit = 26 + (u - '0');
+        else bit = 36 + u % 28;
+        mask |= uint64_t{1} << bit;
+    }
+    return mask;
+}
+
+int FuzzyPattern::score(std::string_view name, std::string_view lower) const
+{
+    if (pattern_.empty())
+    {
+        return 0;
+    }
+
+    // Avanti: dove finisce la prima occorrenza della sottosequenza
+    size_t pidx = 0;
+    size_t end = 0;
+    for (size_t i = 0; i < lower.size(); ++i)
+    {
+        if (lower[i] == pattern_[pidx] && ++pidx == pattern_.size())
+        {
+            end = i + 1;
+            break;
+        }
+    }
+    if (pidx < pattern_.size())
+    {
+        return kNoMatch;
+    }
+
+    // Indietro: la finestra più corta che finisce lì
+    size_t start = end;
+    pidx = pattern_.size();
+    while (pidx > 0)
+    {
+        --start;
+        if (lower[start] == pattern_[pidx - 1])
+        {
+            --pidx;
+        }
+    }
+
+    int score = 0;
+    int consecutive = 0;
+    int first_bonus = 0;
+    bool in_gap = false;
+    CharClass previous = start > 0 ? class_of(name[start - 1]) : CharClass::NonWord;
+    for (size_t i = start; i < end; ++i)
+    {
+        const CharClass current = class_of(name[i]);
+        if (pidx < pattern_.size() && lower[i] == pattern_[pidx])
+        {
+            score += kScoreMatch;
+            int bonus = bonus_for(previous, current);
+            if (consecutive == 0)
+            {
+                first_bonus = bonus;
+            }
+            else
+            {
+                // Una sequenza attaccata eredita il bonus del suo inizio
+                if (bonus >= kBonusBoundary && bonus > first_bonus)
+                {
+                    first_bonus = bonus;
+                }
+                bonus = std::max({bonus, first_bonus, kBonusConsecutive});
+            }
+            score += pidx == 0 ? bonus * kBonusFirstCharMultiplier : bonus;
+            in_gap = false;
+            ++consecutive;
+            ++pidx;
+        }
+        else
+        {
+            score += in_gap ? kScoreGapExtension : kScoreGapStart;
+            in_gap = true;
+            consecutive = 0;
+            first_bonus = 0;
+        }
+        previous = current;
+    }
+    return score;
+}
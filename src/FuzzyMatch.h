@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+// Filtro fuzzy alla fzf: i caratteri del pattern devono comparire nel nome
+// nell'ordine dato, non per forza attaccati ("bpenmboss" → BP_Enemy_Boss).
+//
+// Punteggio come l'algoritmo v1 di fzf: si cerca la prima occorrenza della
+// sottosequenza, poi all'indietro la finestra più corta che la contiene, e
+// la si valuta. Ogni carattere vale kScoreMatch, i buchi costano, e pesano
+// di più i caratteri a inizio parola: dopo '_', '/', '.', '-', su un
+// passaggio camelCase (enemyBoss) o all'inizio di un numero.
+class FuzzyPattern
+{
+public:
+    static constexpr int kNoMatch = std::numeric_limits<int>::min();
+
+    // Spazi ignorati, maiuscole indifferenti
+    explicit FuzzyPattern(std::string_view pattern);
+
+    bool empty() const { return pattern_.empty(); }
+
+    // Prefiltro: i caratteri presenti in un nome (minuscolo) come bit di una
+    // maschera. Se mancano bit del pattern il nome non può corrispondere;
+    // il confronto è un AND, vettorizzabile su una colonna di maschere.
+    static uint64_t char_mask(std::string_view lower);
+    uint64_t char_mask() const { return mask_; }
+
+    // name originale (per il camelCase) e la sua copia in minuscolo;
+    // kNoMatch se il pattern non è una sottosequenza
+    int score(std::string_view name, std::string_view lower) const;
+
+private:
+    std::string pattern_; // minuscolo
+    uint64_t mask_ = 0;
+};
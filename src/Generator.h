@@ -0,0 +1,103 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <optional>
+#include <utility>
+
+// Generatore minimale per coroutine C++20 (std::generator è C++23).
+// Lazy: il corpo avanza solo quando il chiamante chiede il valore
+// successivo. Distruggere il generatore distrugge il frame della coroutine,
+// e con esso gli oggetti locali ancora vivi.
+template <typename T>
+class Generator
+{
+public:
+    struct promise_type
+    {
+        std::optional<T> current;
+        std::exception_ptr error;
+
+        Generator get_return_object() { return Generator(handle::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(T value)
+        {
+            current = std::move(value);
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+    using handle = std::coroutine_handle<promise_type>;
+
+    Generator(Generator &&other) noexcept : coroutine_(std::exchange(other.coroutine_, {})) {}
+    Generator &operator=(Generator &&other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            coroutine_ = std::exchange(other.coroutine_, {});
+        }
+        return *this;
+    }
+    Generator(const Generator &) = delete;
+    Generator &operator=(const Generator &) = delete;
+    ~Generator() { reset(); }
+
+    // Avanza al valore successivo; false a generatore esaurito
+    bool next()
+    {
+        if (!coroutine_ || coroutine_.done()) return false;
+        coroutine_.promise().current.reset();
+        coroutine_.resume();
+        if (coroutine_.promise().error) std::rethrow_exception(coroutine_.promise().error);
+        return !coroutine_.done();
+    }
+
+    T &value() { return *coroutine_.promise().current; }
+
+    // Range-for: for (auto& batch : engine.stream(...))
+    class iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        explicit iterator(Generator *owner) : owner_(owner) { advance(); }
+
+        T &operator*() const { return owner_->value(); }
+        iterator &operator++()
+        {
+            advance();
+            return *this;
+        }
+        void operator++(int) { advance(); }
+        bool operator==(std::default_sentinel_t) const { return owner_ == nullptr; }
+
+    private:
+        void advance()
+        {
+            if (owner_ && !owner_->next()) owner_ = nullptr;
+        }
+        Generator *owner_ = nullptr;
+    };
+
+    iterator begin() { return iterator(this); }
+    std::default_sentinel_t end() { return {}; }
+
+private:
+    explicit Generator(handle coroutine) : coroutine_(coroutine) {}
+
+    void reset()
+    {
+        if (coroutine_) {
+            coroutine_.destroy();
+            coroutine_ = {};
+        }
+    }
+
+    handle coroutine_;
+};
@@ -0,0 +1,360 @@
+#include "LocalIpc.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <afunix.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+std::filesystem::path private_temp_dir()
+{
+    std::error_code ec;
+#ifdef _WIN32
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path(ec);
+    if (ec) {
+        return {};
+    }
+    const std::filesystem::path dir = tmp / "SearchAssetsV2";
+    std::filesystem::create_directories(dir, ec);
+    return ec ? std::filesystem::path() : dir;
+#else
+    std::filesystem::path dir;
+    const char* runtime = std::getenv("XDG_RUNTIME_DIR");
+    if (runtime != nullptr && runtime[0] == '/') {
+        dir = std::filesystem::path(runtime) / "SearchAssetsV2";
+    } else {
+        const std::filesystem::path tmp = std::filesystem::temp_directory_path(ec);
+        if (ec) {
+            return {};
+        }
+        dir = tmp / ("SearchAssetsV2-" + std::to_string(::getuid()));
+    }
+    if (::mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) {
+        return {};
+    }
+    // lstat: un link simbolico messo lì da altri non va seguito
+    struct stat st;
+    if (::lstat(dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode) || st.st_uid != ::getuid()) {
+        return {};
+    }
+    if ((st.st_mode & 077) != 0 && ::chmod(dir.c_str(), 0700) != 0) {
+        return {};
+    }
+    return dir;
+#endif
+}
+
+#ifdef _WIN32
+using native_socket = SOCKET;
+
+// WSAStartup una volta per processo, alla prima creazione di un socket
+static bool ensure_winsock()
+{
+    static const bool ready = [] {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    return ready;
+}
+
+static void close_native(native_socket s) { closesocket(s); }
+#else
+using native_socket = int;
+
+static bool ensure_winsock() { return true; }
+static void close_native(native_socket s) { ::close(s); }
+#endif
+
+static native_socket to_native(intptr_t handle) { return static_cast<native_socket>(handle); }
+
+static bool make_address(const std::filesystem::path& path, sockaddr_un& addr)
+{
+    const std::string utf8 = path.string();
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    // Vuoto: su Linux bind sceglierebbe un indirizzo astratto a caso
+    if (utf8.empty() || utf8.size() >= sizeof(addr.sun_path)) {
+        return false;
+    }
+    std::memcpy(addr.sun_path, utf8.c_str(), utf8.size() + 1);
+    return true;
+}
+
+LocalSocket::LocalSocket(LocalSocket&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+LocalSocket& LocalSocket::operator=(LocalSocket&& other) noexcept
+{
+    if (this != &other) {
+        close();
+        std::swap(handle_, other.handle_);
+        std::swap(bound_path_, other.bound_path_);
+    }
+    return *this;
+}
+
+bool LocalSocket::listen(const std::filesystem::path& path, std::string& error)
+{
+    close();
+
+    if (path.empty()) {
+        error = "no private directory for the daemon socket, pass --socket";
+        return false;
+    }
+    {
+        LocalSocket probe;
+        if (probe.connect(path)) {
+            error = "another daemon is already listening on " + path.string();
+            return false;
+        }
+    }
+
+    sockaddr_un addr;
+    if (!ensure_winsock() || !make_address(path, addr)) {
+        error = "invalid socket path " + path.string();
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    // Nessuno risponde: al path può esserci il socket orfano di un daemon
+    // terminato male, da rimuovere solo se è davvero un socket nostro
+#ifdef _WIN32
+    std::filesystem::remove(path, ec);
+#else
+    struct stat st;
+    if (::lstat(path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode) || st.st_uid != ::getuid()) {
+            error = path.string() + " exists and is not a socket of this user";
+            return false;
+        }
+        ::unlink(path.c_str());
+    }
+#endif
+
+    const native_socket s = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    handle_ = static_cast<intptr_t>(s);
+    if (!valid()) {
+        error = "cannot create socket";
+        return false;
+    }
+    if (::bind(s, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(s, 16) != 0) {
+        error = "cannot bind " + path.string();
+        close();
+        return false;
+    }
+    bound_path_ = path;
+    return true;
+}
+
+LocalSocket LocalSocket::accept() const
+{
+    LocalSocket client;
+    if (valid()) {
+        client.handle_ = static_cast<intptr_t>(::accept(to_native(handle_), nullptr, nullptr));
+    }
+    return client;
+}
+
+bool LocalSocket::connect(const std::filesystem::path& path)
+{
+    close();
+
+    sockaddr_un addr;
+    if (!ensure_winsock() || !make_address(path, addr)) {
+        return false;
+    }
+    const native_socket s = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    handle_ = static_cast<intptr_t>(s);
+    if (!valid()) {
+        return false;
+    }
+    if (::connect(s, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool LocalSocket::send_all(const void* data, size_t size) const
+{
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+#ifdef _WIN32
+        const int chunk = static_cast<int>(std::min<size_t>(size, 1 << 30));
+        const int sent = ::send(to_native(handle_), p, chunk, 0);
+#elif defined(MSG_NOSIGNAL)
+        const ssize_t sent = ::send(to_native(handle_), p, size, MSG_NOSIGNAL); // niente SIGPIPE se il peer è sparito
+#else
+        const ssize_t sent = ::send(to_native(handle_), p, size, 0);
+#endif
+        if (sent <= 0) return false;
+        p += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool LocalSocket::recv_all(void* data, size_t size) const
+{
+    char* p = static_cast<char*>(data);
+    while (size > 0) {
+#ifdef _WIN32
+        const int chunk = static_cast<int>(std::min<size_t>(size, 1 << 30));
+        const int got = ::recv(to_native(handle_), p, chunk, 0);
+#else
+        const ssize_t got = ::recv(to_native(handle_), p, size, 0);
+#endif
+        if (got <= 0) return false;
+        p += got;
+        size -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+void LocalSocket::shutdown()
+{
+    if (valid()) {
+#ifdef _WIN32
+        ::shutdown(to_native(handle_), SD_BOTH);
+#else
+        ::shutdown(to_native(handle_), SHUT_RDWR);
+#endif
+    }
+}
+
+void LocalSocket::close()
+{
+    if (valid()) {
+        close_native(to_native(handle_));
+        handle_ = kInvalid;
+    }
+    if (!bound_path_.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(bound_path_, ec);
+        bound_path_.clear();
+    }
+}
+
+std::string SharedMemory::unique_name()
+{
+    static std::atomic<unsigned> counter{0};
+#ifdef _WIN32
+    const unsigned long pid = GetCurrentProcessId();
+    return "Local\\SearchAssetsV2-" + std::to_string(pid) + "-" + std::to_string(++counter);
+#else
+    return "/SearchAssetsV2-" + std::to_string(::getpid()) + "-" + std::to_string(++counter);
+#endif
+}
+
+bool SharedMemory::create(const std::string& name, size_t size)
+{
+    close();
+    if (size == 0) return false;
+
+#ifdef _WIN32
+    const std::wstring wide = std::filesystem::path(name).wstring();
+    HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+                                        static_cast<DWORD>(size & 0xFFFFFFFFu), wide.c_str());
+    if (mapping == nullptr) return false;
+    void* view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        return false;
+    }
+    mapping_ = mapping;
+    data_ = static_cast<char*>(view);
+#else
+    const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return false;
+    void* view = MAP_FAILED;
+    if (::ftruncate(fd, static_cast<off_t>(size)) == 0) {
+        view = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (view == MAP_FAILED) {
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        return false;
+    }
+    fd_ = fd;
+    data_ = static_cast<char*>(view);
+#endif
+    size_ = size;
+    owner_ = true;
+    name_ = name;
+    return true;
+}
+
+bool SharedMemory::open(const std::string& name, size_t size)
+{
+    close();
+    if (size == 0) return false;
+
+#ifdef _WIN32
+    const std::wstring wide = std::filesystem::path(name).wstring();
+    HANDLE mapping = OpenFileMappingW(FILE_MAP_READ, FALSE, wide.c_str());
+    if (mapping == nullptr) return false;
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        return false;
+    }
+    mapping_ = mapping;
+    data_ = static_cast<char*>(view);
+#else
+    const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+    void* view = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    fd_ = fd;
+    data_ = static_cast<char*>(view);
+#endif
+    size_ = size;
+    owner_ = false;
+    name_ = name;
+    return true;
+}
+
+void SharedMemory::close()
+{
+    if (data_ == nullptr) return;
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle(mapping_);
+    mapping_ = nullptr;
+#else
+    ::munmap(data_, size_);
+    ::close(fd_);
+    fd_ = -1;
+    if (owner_) {
+        ::shm_unlink(name_.c_str());
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    owner_ = false;
+    name_.clear();
+}
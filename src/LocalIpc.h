@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// Directory privata dell'utente per socket del daemon, lock e snapshot:
+// $XDG_RUNTIME_DIR/SearchAssetsV2 o <temp>/SearchAssetsV2-<uid>, creata
+// 0700. Vuota se non si riesce a crearla o se esiste ma non è una directory
+// dell'utente (un altro utente potrebbe averla preparata per sé).
+// Su Windows la directory temporanea è già per utente.
+std::filesystem::path private_temp_dir();
+
+// Socket Unix locale (AF_UNIX, anche su Windows 10 1803+). RAII come
+// MappedFile: il distruttore chiude il socket.
+class LocalSocket
+{
+public:
+    LocalSocket() = default;
+    ~LocalSocket() { close(); }
+
+    LocalSocket(const LocalSocket &) = delete;
+    LocalSocket &operator=(const LocalSocket &) = delete;
+    LocalSocket(LocalSocket &&other) noexcept;
+    LocalSocket &operator=(LocalSocket &&other) noexcept;
+
+    // Lato server. Un socket file rimasto da un daemon morto dell'utente
+    // viene rimosso; se invece risponde qualcuno, o al path c'è altro,
+    // listen fallisce.
+    bool listen(const std::filesystem::path &path, std::string &error);
+    LocalSocket accept() const;
+
+    // Lato client
+    bool connect(const std::filesystem::path &path);
+
+    bool valid() const { return handle_ != kInvalid; }
+
+    // Bloccanti: false se la connessione cade prima di aver finito
+    bool send_all(const void *data, size_t size) const;
+    bool recv_all(void *data, size_t size) const;
+
+    // Sblocca accept/recv pendenti in altri thread
+    void shutdown();
+    void close();
+
+private:
+    static constexpr intptr_t kInvalid = -1; // SOCKET o fd
+    intptr_t handle_ = kInvalid;
+    std::filesystem::path bound_path_; // rimosso alla chiusura del server
+};
+
+// Segmento di memoria condivisa con nome (shm_open / CreateFileMapping).
+// Chi lo crea lo scrive e lo rimuove alla chiusura; chi lo apre lo legge.
+class SharedMemory
+{
+public:
+    SharedMemory() = default;
+    ~SharedMemory() { close(); }
+
+    SharedMemory(const SharedMemory &) = delete;
+    SharedMemory &operator=(const SharedMemory &) = delete;
+
+    // Nome univoco per il processo corrente
+    static std::string unique_name();
+
+    bool create(const std::string &name, size_t size);
+    bool open(const std::string &name, size_t size);
+    void close();
+
+    char *data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    char *data_ = nullptr;
+    size_t size_ = 0;
+    bool owner_ = false;
+    std::string name_;
+#ifdef _WIN32
+    void *mapping_ = nullptr; // HANDLE
+#else
+    int fd_ = -1;
+#endif
+};
@@ -0,0 +1,135 @@
+#include "MappedFile.h"
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        close();
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+#ifdef _WIN32
+        std::swap(file_, other.file_);
+        std::swap(mapping_, other.mapping_);
+#else
+        std::swap(fd_, other.fd_);
+        std::swap(drop_on_close_, other.drop_on_close_);
+#endif
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::filesystem::path::value_type* path, Access access)
+{
+    close();
+
+#ifdef _WIN32
+    const DWORD flags = access != Access::Normal ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL;
+    HANDLE hFile = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ,
+                               nullptr, OPEN_EXISTING, flags, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    file_ = hFile;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0) {
+        close();
+        return false;
+    }
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+
+    mapping_ = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ == nullptr) {
+        close();
+        return false;
+    }
+
+    data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (data_ == nullptr) {
+        close();
+        return false;
+    }
+#else
+    fd_ = ::open(path, O_RDONLY);
+    if (fd_ == -1) {
+        return false;
+    }
+
+    struct stat sb;
+    if (fstat(fd_, &sb) == -1 || sb.st_size == 0) {
+        close();
+        return false;
+    }
+    size_ = static_cast<size_t>(sb.st_size);
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    if (access != Access::Normal) {
+        posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL); // finestra di readahead più ampia
+    }
+#endif
+    drop_on_close_ = access == Access::Streaming;
+
+    void* mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (mapped == MAP_FAILED) {
+        close();
+        return false;
+    }
+    data_ = static_cast<const char*>(mapped);
+    if (access != Access::Normal) {
+        madvise(mapped, size_, MADV_SEQUENTIAL);
+    }
+#endif
+    return true;
+}
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+    if (data_ != nullptr) UnmapViewOfFile(data_);
+    if (mapping_ != nullptr) CloseHandle(mapping_);
+    if (file_ != nullptr) CloseHandle(file_);
+    mapping_ = nullptr;
+    file_ = nullptr;
+#else
+    if (data_ != nullptr) munmap(const_cast<char*>(data_), size_);
+#ifdef POSIX_FADV_DONTNEED
+    if (fd_ != -1 && drop_on_close_) posix_fadvise(fd_, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+    if (fd_ != -1) ::close(fd_);
+    fd_ = -1;
+    drop_on_close_ = false;
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+void MappedFile::prefetch(const std::filesystem::path::value_type* path)
+{
+#if !defined(_WIN32) && defined(POSIX_FADV_WILLNEED)
+    const int fd = ::open(path, O_RDONLY);
+    if (fd == -1) {
+        return;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED); // readahead asincrono, ritorna subito
+    ::close(fd);
+#else
+    (void)path; // Windows: nessun equivalente senza mappare il file
+#endif
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+// File mappato in memoria in sola lettura (MapViewOfFile / mmap).
+// RAII: la vista e gli handle vengono rilasciati dal distruttore.
+class MappedFile
+{
+public:
+    // Sequential: il file verrà letto una volta dall'inizio alla fine,
+    // il kernel può leggere avanti in modo aggressivo.
+    // Streaming: come Sequential, e alla chiusura le sue pagine escono dalla
+    // page cache (non servirà più, lascia il posto ad altro).
+    enum class Access { Normal, Sequential, Streaming };
+
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path &path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    // false se il file non esiste, non è leggibile o è vuoto
+    bool open(const std::filesystem::path &path, Access access = Access::Normal) { return open(path.c_str(), access); }
+    // Path nativo terminato da '\0', senza costruire un std::filesystem::path
+    bool open(const std::filesystem::path::value_type *path, Access access = Access::Normal);
+    void close();
+
+    // Chiede al kernel di iniziare a leggere il file in background
+    // (POSIX_FADV_WILLNEED), senza aspettare. No-op dove non supportato.
+    static void prefetch(const std::filesystem::path &path) { prefetch(path.c_str()); }
+    static void prefetch(const std::filesystem::path::value_type *path);
+
+    bool is_open() const { return data_ != nullptr; }
+    const char *data() const { return data_; }
+    size_t size() const { return size_; }
+    std::string_view view() const { return std::string_view(data_, size_); }
+
+private:
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void *file_ = nullptr;    // HANDLE, nullptr = chiuso
+    void *mapping_ = nullptr; // HANDLE
+#else
+    int fd_ = -1;
+    bool drop_on_close_ = false;
+#endif
+};
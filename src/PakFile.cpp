@@ -0,0 +1,519 @@
+#include "PakFile.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <zlib.h>
+
+namespace
+{
+constexpr uint32_t kPakMagic = 0x5A6F12E1;
+
+// EPakFileVersion
+constexpr int32_t kVersionNoTimestamps          = 2;
+constexpr int32_t kVersionCompressionEncryption = 3;
+constexpr int32_t kVersionIndexEncryption       = 4;
+constexpr int32_t kVersionRelativeChunkOffsets  = 5;
+constexpr int32_t kVersionFNameCompression      = 8;
+constexpr int32_t kVersionFrozenIndex           = 9;
+constexpr int32_t kVersionPathHashIndex         = 10;
+constexpr int32_t kVersionLatest                = 11;
+
+constexpr size_t kInfoSize            = 44; // magic .. hash dell'indice
+constexpr size_t kCompressionNameSize = 32;
+constexpr uint64_t kMaxDeflateRatio   = 1032; // byte decompressi per byte compresso, al massimo
+
+void append_utf8(std::string& out, uint32_t cp)
+{
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+bool iequals(std::string_view a, std::string_view b)
+{
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return (x | 0x20) == (y | 0x20);
+           });
+}
+} // namespace
+
+// Lettura little-endian con controllo dei limiti: un errore azzera il
+// resto della lettura invece di uscire dal buffer.
+class PakFile::Reader
+{
+public:
+    Reader(const char* data, size_t size) : data_(data), size_(size) {}
+
+    template <typename T>
+    T read()
+    {
+        T value{};
+        if (size_ - pos_ < sizeof(T)) {
+            fail();
+            return value;
+        }
+        std::memcpy(&value, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+
+    void skip(size_t n)
+    {
+        if (size_ - pos_ < n) fail();
+        else pos_ += n;
+    }
+
+    std::string_view bytes(size_t n)
+    {
+        if (size_ - pos_ < n) {
+            fail();
+            return {};
+        }
+        std::string_view out(data_ + pos_, n);
+        pos_ += n;
+        return out;
+    }
+
+    // FString: lunghezza col terminatore, negativa = UTF-16
+    std::string read_string()
+    {
+        const int32_t length = read<int32_t>();
+        std::string out;
+        if (length > 0) {
+            const std::string_view chars = bytes(static_cast<size_t>(length));
+            if (!chars.empty()) out.assign(chars.data(), chars.size() - 1);
+        } else if (length < 0 && length != INT32_MIN) {
+            const std::string_view units = bytes(static_cast<size_t>(-length) * 2);
+            for (size_t i = 0; i + 2 < units.size(); i += 2) { // l'ultima unit è il terminatore
+                uint32_t cp = static_cast<unsigned char>(units[i]) |
+                              (static_cast<unsigned char>(units[i + 1]) << 8);
+                if (cp >= 0xD800 && cp < 0xDC00 && i + 4 < units.size()) {
+                    const uint32_t low = static_cast<unsigned char>(units[i + 2]) |
+                                         (static_cast<unsigned char>(units[i + 3]) << 8);
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    i += 2;
+                }
+                append_utf8(out, cp);
+            }
+        } else if (length == INT32_MIN) {
+            fail();
+        }
+        return out;
+    }
+
+    bool ok() const { return ok_; }
+    size_t remaining() const { return size_ - pos_; }
+
+private:
+    void fail()
+    {
+        ok_ = false;
+        pos_ = size_;
+    }
+
+    const char* data_;
+    size_t size_;
+    size_t pos_ = 0;
+    bool ok_ = true;
+};
+
+bool PakFile::is_pak_name(std::string_view file_name)
+{
+    return file_name.size() > 4 && iequals(file_name.substr(file_name.size() - 4), ".pak");
+}
+
+void PakFile::close()
+{
+    file_.close();
+    version_ = 0;
+    encrypted_index_ = false;
+    index_offset_ = index_size_ = 0;
+    methods_.clear();
+    mount_point_.clear();
+    entries_.clear();
+    blocks_.clear();
+}
+
+bool PakFile::open(const std::filesystem::path& path)
+{
+    close();
+    if (!file_.open(path) || !read_footer() || !read_index(index_offset_, index_size_)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+// FPakInfo sta in coda al file, con dimensione variabile secondo la versione:
+// si cerca il magic negli ultimi byte e si valida quello che segue.
+bool PakFile::read_footer()
+{
+    const char* data = file_.data();
+    const size_t size = file_.size();
+    if (size < kInfoSize) return false;
+
+    const size_t lowest = size > 512 ? size - 512 : 0;
+    for (size_t p = size - kInfoSize + 1; p-- > lowest;) {
+        uint32_t magic = 0;
+        std::memcpy(&magic, data + p, 4);
+        if (magic != kPakMagic) continue;
+
+        int32_t version = 0;
+        int64_t index_offset = 0, index_size = 0;
+        std::memcpy(&version, data + p + 4, 4);
+        std::memcpy(&index_offset, data + p + 8, 8);
+        std::memcpy(&index_size, data + p + 16, 8);
+        if (version < 1 || version > kVersionLatest || index_offset < 0 || index_size <= 0 ||
+            static_cast<uint64_t>(index_offset) + static_cast<uint64_t>(index_size) > p) {
+            continue;
+        }
+
+        size_t tail = p + kInfoSize;
+        if (version == kVersionFrozenIndex) {
+            if (size == tail || data[size - 1] != 0) return false; // indice "frozen" (4.25): non supportato
+        }
+        if (version >= kVersionFNameCompression) {
+            const size_t names_end = size - (version == kVersionFrozenIndex ? 1 : 0);
+            for (; tail + kCompressionNameSize <= names_end; tail += kCompressionNameSize) {
+                const char* name = data + tail;
+                methods_.emplace_back(name, strnlen(name, kCompressionNameSize));
+            }
+        }
+
+        version_ = version;
+        encrypted_index_ = version >= kVersionIndexEncryption && p > 0 && data[p - 1] != 0;
+        index_offset_ = static_cast<uint64_t>(index_offset);
+        index_size_ = static_cast<uint64_t>(index_size);
+        return true;
+    }
+    return false;
+}
+
+bool PakFile::read_index(uint64_t offset, uint64_t size)
+{
+    if (encrypted_index_) return false; // senza chiave AES non si legge
+
+    Reader reader(file_.data() + offset, size);
+    std::string mount = reader.read_string();
+    // "../../../Game/Content/" → "Game/Content/"
+    size_t skip = 0;
+    while (mount.compare(skip, 3, "../") == 0) skip += 3;
+    while (skip < mount.size() && mount[skip] == '/') ++skip;
+    mount_point_ = mount.substr(skip);
+    if (!mount_point_.empty() && mount_point_.back() != '/') mount_point_.push_back('/');
+
+    const int32_t count = reader.read<int32_t>();
+    if (!reader.ok() || count < 0) return false;
+
+    if (version_ < kVersionPathHashIndex) {
+        entries_.reserve(std::min(static_cast<size_t>(count), reader.remaining()));
+        for (int32_t i = 0; i < count && reader.ok(); ++i) {
+            Entry entry;
+            entry.path = reader.read_string();
+            if (!read_entry(reader, entry)) return false;
+            entries_.push_back(std::move(entry));
+        }
+        return reader.ok();
+    }
+
+    // v10+: entry codificate in un blob, nomi nel directory index separato
+    reader.skip(8);                                  // PathHashSeed
+    if (reader.read<uint32_t>() != 0) {
+        reader.skip(8 + 8 + 20);                     // path hash index: non serve
+    }
+    const bool has_directory_index = reader.read<uint32_t>() != 0;
+    int64_t directory_offset = 0, directory_size = 0;
+    if (has_directory_index) {
+        directory_offset = reader.read<int64_t>();
+        directory_size = reader.read<int64_t>();
+        reader.skip(20);
+    }
+    const int32_t encoded_size = reader.read<int32_t>();
+    if (encoded_size < 0) return false;
+    const std::string_view encoded = reader.bytes(static_cast<size_t>(encoded_size));
+
+    const int32_t file_count = reader.read<int32_t>();
+    if (!reader.ok() || file_count < 0) return false;
+    std::vector<Entry> files(static_cast<size_t>(std::min<int64_t>(file_count, static_cast<int64_t>(reader.remaining()))));
+    for (auto& entry : files) {
+        if (!read_entry(reader, entry)) return false;
+    }
+
+    if (!has_directory_index || directory_offset < 0 || directory_size <= 0 ||
+        static_cast<uint64_t>(directory_offset) + static_cast<uint64_t>(directory_size) > file_.size()) {
+        return false; // solo path hash: i nomi non sono ricostruibili
+    }
+    return read_directory_index(static_cast<uint64_t>(directory_offset),
+                                static_cast<uint64_t>(directory_size), encoded, files);
+}
+
+// FPakEntry serializzata per esteso (indice pre-v10 e entry non codificabili)
+bool PakFile::read_entry(Reader& reader, Entry& entry)
+{
+    entry.offset = static_cast<uint64_t>(reader.read<int64_t>());
+    entry.size = static_cast<uint64_t>(reader.read<int64_t>());
+    entry.uncompressed_size = static_cast<uint64_t>(reader.read<int64_t>());
+    if (version_ < kVersionFNameCompression) {
+        const int32_t flags = reader.read<int32_t>(); // ECompressionFlags
+        entry.compression = flags == 0 ? Compression::None
+                          : (flags & 0x01) ? Compression::Zlib
+                          : (flags & 0x02) ? Compression::Gzip
+                          : Compression::Unsupported;
+    } else {
+        entry.compression = method_from_index(reader.read<uint32_t>());
+    }
+    if (version_ < kVersionNoTimestamps) {
+        reader.skip(8);
+    }
+    reader.skip(20); // SHA1
+
+    if (version_ >= kVersionCompressionEncryption) {
+        if (entry.compression != Compression::None) {
+            const int32_t count = reader.read<int32_t>();
+            if (count < 0 || static_cast<size_t>(count) > reader.remaining() / 16) return false;
+            const uint64_t base = version_ >= kVersionRelativeChunkOffsets ? entry.offset : 0;
+            entry.first_block = static_cast<uint32_t>(blocks_.size());
+            entry.block_count = static_cast<uint32_t>(count);
+            for (int32_t i = 0; i < count; ++i) {
+                const uint64_t start = static_cast<uint64_t>(reader.read<int64_t>());
+                const uint64_t end = static_cast<uint64_t>(reader.read<int64_t>());
+                blocks_.push_back({base + start, base + end});
+            }
+        }
+        entry.encrypted = (reader.read<uint8_t>() & 0x01) != 0;
+        entry.block_size = reader.read<uint32_t>();
+    }
+    return reader.ok();
+}
+
+// FPakFile::DecodePakEntry: bitfield a 32 bit seguito dai soli campi che
+// non stanno nel bitfield, con larghezza 32 o 64 bit secondo i flag.
+bool PakFile::decode_entry(Reader& reader, Entry& entry)
+{
+    const uint32_t bits = reader.read<uint32_t>();
+
+    entry.block_size = (bits & 0x3F) == 0x3F ? reader.read<uint32_t>() : (bits & 0x3F) << 11;
+    const uint32_t method = (bits >> 23) & 0x3F;
+    entry.offset = (bits & (1u << 31)) ? reader.read<uint32_t>() : static_cast<uint64_t>(reader.read<int64_t>());
+    entry.uncompressed_size = (bits & (1u << 30)) ? reader.read<uint32_t>() : static_cast<uint64_t>(reader.read<int64_t>());
+    if (method != 0) {
+        entry.size = (bits & (1u << 29)) ? reader.read<uint32_t>() : static_cast<uint64_t>(reader.read<int64_t>());
+    } else {
+        entry.size = entry.uncompressed_size;
+    }
+    entry.encrypted = (bits & (1u << 22)) != 0;
+    entry.compression = method_from_index(method);
+    entry.block_count = (bits >> 6) & 0xFFFF;
+    entry.first_block = static_cast<uint32_t>(blocks_.size());
+
+    // I blocchi seguono l'header della entry, in ordine e contigui
+    uint64_t position = entry.offset + serialized_entry_size(entry);
+    if (entry.block_count == 1 && !entry.encrypted) {
+        blocks_.push_back({position, position + entry.size});
+    } else {
+        for (uint32_t i = 0; i < entry.block_count; ++i) {
+            const uint32_t length = reader.read<uint32_t>();
+            blocks_.push_back({position, position + length});
+            position += entry.encrypted ? (length + 15) & ~uint64_t(15) : length; // allineamento AES
+        }
+    }
+    return reader.ok();
+}
+
+bool PakFile::read_directory_index(uint64_t offset, uint64_t size,
+                                   std::string_view encoded, const std::vector<Entry>& files)
+{
+    Reader reader(file_.data() + offset, size);
+    const int32_t dir_count = reader.read<int32_t>();
+    for (int32_t d = 0; d < dir_count && reader.ok(); ++d) {
+        std::string dir = reader.read_string();
+        // "/" = root del mount point, altrimenti "Content/Weapons/"
+        size_t skip = 0;
+        while (skip < dir.size() && dir[skip] == '/') ++skip;
+        dir.erase(0, skip);
+        if (!dir.empty() && dir.back() != '/') dir.push_back('/');
+
+        const int32_t file_count = reader.read<int32_t>();
+        for (int32_t f = 0; f < file_count && reader.ok(); ++f) {
+            std::string name = reader.read_string();
+            const int32_t location = reader.read<int32_t>();
+            if (location == INT32_MAX) continue; // entry cancellata
+
+            Entry entry;
+            if (location >= 0) {
+                if (static_cast<size_t>(location) >= encoded.size()) continue;
+                Reader entry_reader(encoded.data() + location, encoded.size() - static_cast<size_t>(location));
+                if (!decode_entry(entry_reader, entry)) continue;
+            } else {
+                const size_t index = static_cast<size_t>(-(static_cast<int64_t>(location) + 1));
+                if (index >= files.size()) continue;
+                entry = files[index];
+            }
+            entry.path = dir + name;
+            entries_.push_back(std::move(entry));
+        }
+    }
+    return reader.ok();
+}
+
+PakFile::Compression PakFile::method_from_index(uint32_t index) const
+{
+    if (index == 0) return Compression::None;
+    if (index - 1 >= methods_.size()) return Compression::Unsupported;
+    const std::string& name = methods_[index - 1];
+    if (iequals(name, "zlib")) return Compression::Zlib;
+    if (iequals(name, "gzip")) return Compression::Gzip;
+    return Compression::Unsupported; // Oodle, LZ4, ...
+}
+
+// FPakEntry::GetSerializedSize: l'header ripetuto davanti ai dati di ogni entry
+uint64_t PakFile::serialized_entry_size(const Entry& entry) const
+{
+    uint64_t size = 8 + 8 + 8 + 20 + 4; // offset, size, uncompressed, hash, compressione
+    if (version_ >= kVersionCompressionEncryption) {
+        size += 1 + 4;                  // flags, block size
+        if (entry.compression != Compression::None) {
+            size += 4 + 16 * static_cast<uint64_t>(entry.block_count);
+        }
+    }
+    if (version_ < kVersionNoTimestamps) {
+        size += 8;
+    }
+    return size;
+}
+
+bool PakFile::can_read(const Entry& entry) const
+{
+    if (entry.encrypted) return false;
+    switch (entry.compression) {
+        case Compression::None: return true;
+        case Compression::Zlib:
+        case Compression::Gzip: return entry.block_count > 0;
+        default:                return false;
+    }
+}
+
+// La size decompressa arriva dall'archivio: prima di allocare si controlla
+// contro quanto i blocchi possono produrre, block_size ciascuno (senza
+// block_size, il rapporto massimo di deflate)
+bool PakFile::blocks_valid(const Entry& entry) const
+{
+    if (static_cast<uint64_t>(entry.first_block) + entry.block_count > blocks_.size()) return false;
+    const uint64_t file_size = file_.size();
+    uint64_t limit = 0;
+    for (uint32_t b = 0; b < entry.block_count; ++b) {
+        const Block& block = blocks_[entry.first_block + b];
+        if (block.end > file_size || block.start > block.end || block.end - block.start > UINT_MAX) {
+            return false;
+        }
+        limit += entry.block_size != 0 ? entry.block_size : (block.end - block.start) * kMaxDeflateRatio;
+    }
+    return entry.uncompressed_size <= limit && entry.uncompressed_size <= SIZE_MAX;
+}
+
+bool PakFile::read(const Entry& entry, std::string& buffer, std::string_view& content) const
+{
+    if (!can_read(entry)) return false;
+
+    const char* data = file_.data();
+    const uint64_t file_size = file_.size();
+
+    if (entry.compression == Compression::None) {
+        const uint64_t start = entry.offset + serialized_entry_size(entry);
+        if (start > file_size || entry.uncompressed_size > file_size - start) return false;
+        content = std::string_view(data + start, static_cast<size_t>(entry.uncompressed_size));
+        return true;
+    }
+
+    if (!blocks_valid(entry)) return false;
+
+    // Un blocco alla volta direttamente nel buffer finale: l'input viene
+    // letto dalla mappa, nessuna copia intermedia
+    buffer.resize(static_cast<size_t>(entry.uncompressed_size));
+    z_stream stream{};
+    if (inflateInit2(&stream, entry.compression == Compression::Gzip ? 16 + MAX_WBITS : MAX_WBITS) != Z_OK) {
+        return false;
+    }
+
+    size_t produced = 0;
+    bool ok = true;
+    for (uint32_t b = 0; b < entry.block_count && ok; ++b) {
+        const Block& block = blocks_[entry.first_block + b];
+        const size_t room = buffer.size() - produced;
+        const size_t expected = entry.block_size != 0 ? std::min<size_t>(entry.block_size, room) : room;
+
+        inflateReset(&stream);
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data + block.start));
+        stream.avail_in = static_cast<uInt>(block.end - block.start);
+        stream.next_out = reinterpret_cast<Bytef*>(buffer.data() + produced);
+        stream.avail_out = static_cast<uInt>(expected);
+        ok = inflate(&stream, Z_FINISH) == Z_STREAM_END;
+        produced += expected - stream.avail_out;
+    }
+    inflateEnd(&stream);
+
+    if (!ok || produced != buffer.size()) return false;
+    content = std::string_view(buffer.data(), buffer.size());
+    return true;
+}
+
+bool PakFile::can_read_chunks(const Entry& entry, size_t keep) const
+{
+    // Ogni blocco tranne l'ultimo produce block_size byte: la coda tenuta
+    // deve starci dentro con margine
+    return can_read(entry) && entry.compression != Compression::None &&
+           entry.block_count > 1 && entry.block_size > 2 * keep;
+}
+
+bool PakFile::read_chunks(const Entry& entry, size_t keep, std::string& buffer, const ChunkFn& fn) const
+{
+    if (!can_read_chunks(entry, keep) || !blocks_valid(entry)) return false;
+
+    const char* data = file_.data();
+    buffer.resize(keep + entry.block_size);
+    z_stream stream{};
+    if (inflateInit2(&stream, entry.compression == Compression::Gzip ? 16 + MAX_WBITS : MAX_WBITS) != Z_OK) {
+        return false;
+    }
+
+    uint64_t produced = 0; // byte dell'entry decompressi finora
+    size_t carried = 0;    // coda del blocco precedente in testa al buffer
+    bool ok = true;
+    for (uint32_t b = 0; b < entry.block_count && ok; ++b) {
+        const Block& block = blocks_[entry.first_block + b];
+        const bool last = b + 1 == entry.block_count;
+        const size_t expected = static_cast<size_t>(std::min<uint64_t>(entry.block_size, entry.uncompressed_size - produced));
+
+        inflateReset(&stream);
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data + block.start));
+        stream.avail_in = static_cast<uInt>(block.end - block.start);
+        stream.next_out = reinterpret_cast<Bytef*>(buffer.data() + carried);
+        stream.avail_out = static_cast<uInt>(expected);
+        // Blocco pieno (l'ultimo chiude l'entry): altrimenti i conti sugli
+        // offset dei pezzi dopo non tornano
+        ok = expected > 0 && inflate(&stream, Z_FINISH) == Z_STREAM_END && stream.avail_out == 0;
+        produced += expected;
+        ok = ok && (!last || produced == entry.uncompressed_size);
+        if (!ok) break;
+
+        const size_t window = carried + expected;
+        if (!fn(std::string_view(buffer.data(), window), produced - window, last)) break;
+        carried = std::min(keep, window);
+        std::memmove(buffer.data(), buffer.data() + window - carried, carried);
+    }
+    inflateEnd(&stream);
+    return ok;
+}
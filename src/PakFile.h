@@ -0,0 +1,93 @@
+#pragma once
+
+#include "MappedFile.h"
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Lettore in sola lettura degli archivi .pak di Unreal (versioni 1..11).
+//
+// L'archivio viene mappato in memoria; open() legge footer e indice e
+// produce la lista delle entry, ognuna trattabile come un file virtuale.
+// read() restituisce il contenuto di una entry: le entry non compresse
+// puntano direttamente nella mappa, quelle compresse (Zlib/Gzip) vengono
+// decompresse blocco per blocco in un buffer del chiamante, per intero o
+// un blocco alla volta (read_chunks). Niente file
+// temporanei. Indici o entry cifrate e compressori proprietari (Oodle)
+// non sono leggibili e vengono saltati.
+class PakFile
+{
+public:
+    enum class Compression : uint8_t { None, Zlib, Gzip, Unsupported };
+
+    struct Entry
+    {
+        std::string path;             // relativo al mount point, separatore '/'
+        uint64_t offset = 0;          // inizio dell'header della entry nell'archivio
+        uint64_t size = 0;            // byte su disco (compressi)
+        uint64_t uncompressed_size = 0;
+        uint32_t block_size = 0;      // dimensione decompressa di ogni blocco
+        uint32_t first_block = 0;     // blocchi compressi: [first_block, first_block + block_count)
+        uint32_t block_count = 0;
+        Compression compression = Compression::None;
+        bool encrypted = false;
+    };
+
+    static bool is_pak_name(std::string_view file_name);
+
+    // false se non è un pak valido o se l'indice non è leggibile (cifrato,
+    // v10+ senza directory index)
+    bool open(const std::filesystem::path &path);
+    void close();
+
+    // Mount point senza i "../" iniziali: "Game/Content/" o vuoto
+    const std::string &mount_point() const { return mount_point_; }
+    const std::vector<Entry> &entries() const { return entries_; }
+
+    bool can_read(const Entry &entry) const;
+
+    // content punta nella mappa (entry non compresse) o in buffer
+    bool read(const Entry &entry, std::string &buffer, std::string_view &content) const;
+
+    // Entry compresse, un blocco alla volta: fn(window, offset, last) riceve
+    // i byte di un blocco preceduti dagli ultimi keep byte del precedente
+    // (offset = posizione di window nell'entry), così un match a cavallo
+    // di due blocchi resta intero. fn ritorna false per fermarsi prima
+    // della fine. In memoria c'è solo keep + block_size. false se l'entry
+    // non è leggibile a blocchi (vedi can_read_chunks) o è corrotta.
+    using ChunkFn = std::function<bool(std::string_view window, uint64_t offset, bool last)>;
+    bool can_read_chunks(const Entry &entry, size_t keep) const;
+    bool read_chunks(const Entry &entry, size_t keep, std::string &buffer, const ChunkFn &fn) const;
+
+private:
+    struct Block
+    {
+        uint64_t start; // offset assoluti nell'archivio
+        uint64_t end;
+    };
+
+    class Reader;
+
+    bool blocks_valid(const Entry &entry) const;
+    bool read_footer();
+    bool read_index(uint64_t offset, uint64_t size);
+    bool read_entry(Reader &reader, Entry &entry);
+    bool decode_entry(Reader &reader, Entry &entry);
+    bool read_directory_index(uint64_t offset, uint64_t size,
+                              std::string_view encoded, const std::vector<Entry> &files);
+    Compression method_from_index(uint32_t index) const;
+    uint64_t serialized_entry_size(const Entry &entry) const;
+
+    MappedFile file_;
+    int32_t version_ = 0;
+    bool encrypted_index_ = false;
+    uint64_t index_offset_ = 0;
+    uint64_t index_size_ = 0;
+    std::vector<std::string> methods_; // nomi dei compressori (v8+), indice 0 = primo
+    std::string mount_point_;
+    std::vector<Entry> entries_;
+    std::vector<Block> blocks_;
+};
@@ -0,0 +1,236 @@
+#include "PathIndex.h"
+#include <algorithm>
+#include <bit>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PATHINDEX_SSE2 1
+#endif
+
+// Folding ASCII: i nomi degli asset sono ASCII, niente locale.
+static inline unsigned char fold(unsigned char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c | 0x20) : c;
+}
+
+static std::string fold_copy(std::string_view s)
+{
+    std::string out(s);
+    for (char& c : out) c = static_cast<char>(fold(static_cast<unsigned char>(c)));
+    return out;
+}
+
+// needle è già in minuscolo
+static inline bool equal_folded(const char* hay, std::string_view needle)
+{
+    for (size_t k = 0; k < needle.size(); ++k) {
+        if (fold(static_cast<unsigned char>(hay[k])) != static_cast<unsigned char>(needle[k]))
+            return false;
+    }
+    return true;
+}
+
+// Prossima occorrenza case-insensitive di needle (minuscolo) in hay[from, n).
+// Filtro SIMD su primo e ultimo carattere, verifica completa solo sui candidati.
+static size_t find_folded(const char* hay, size_t n, size_t from, std::string_view needle)
+{
+    const size_t m = needle.size();
+    if (m == 0) return from;
+    if (n < m) return std::string_view::npos;
+
+    size_t i = from;
+#ifdef PATHINDEX_SSE2
+    const unsigned char first = static_cast<unsigned char>(needle.front());
+    const unsigned char last  = static_cast<unsigned char>(needle.back());
+    auto upper = [](unsigned char c) {
+        return (c >= 'a' && c <= 'z') ? static_cast<unsigned char>(c & ~0x20) : c;
+    };
+    const __m128i f_lo = _mm_set1_epi8(static_cast<char>(first));
+    const __m128i f_up = _mm_set1_epi8(static_cast<char>(upper(first)));
+    const __m128i l_lo = _mm_set1_epi8(static_cast<char>(last));
+    const __m128i l_up = _mm_set1_epi8(static_cast<char>(upper(last)));
+
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i + m - 1));
+        const __m128i eq = _mm_and_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(a, f_lo), _mm_cmpeq_epi8(a, f_up)),
+            _mm_or_si128(_mm_cmpeq_epi8(b, l_lo), _mm_cmpeq_epi8(b, l_up)));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(eq));
+        while (mask != 0) {
+            const unsigned bit = static_cast<unsigned>(std::countr_zero(mask));
+            if (equal_folded(hay + i + bit, needle)) return i + bit;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i + m <= n; ++i) {
+        if (equal_folded(hay + i, needle)) return i;
+    }
+    return std::string_view::npos;
+}
+
+// Glob case-insensitive ('*' e '?') sul nome intero; pattern già in minuscolo.
+static bool glob_match(std::string_view name, std::string_view pattern)
+{
+    size_t n = 0, p = 0;
+    size_t star = std::string_view::npos, star_n = 0;
+    while (n < name.size()) {
+        if (p < pattern.size() && (pattern[p] == '?' ||
+            static_cast<unsigned char>(pattern[p]) == fold(static_cast<unsigned char>(name[n])))) {
+            ++n; ++p;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            star_n = n;
+        } else if (star != std::string_view::npos) {
+            p = star + 1;
+            n = ++star_n;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') ++p;
+    return p == pattern.size();
+}
+
+void PathIndex::clear()
+{
+    dirs_.clear();
+    dir_ids_.clear();
+    last_dir_ = UINT32_MAX;
+    dir_of_.clear();
+    name_offset_.clear();
+    names_.clear();
+}
+
+void PathIndex::reserve(size_t file_count)
+{
+    dir_of_.reserve(dir_of_.size() + file_count);
+    name_offset_.reserve(name_offset_.size() + file_count);
+    names_.reserve(names_.size() + file_count * 24); // nome medio di un asset
+}
+
+uint32_t PathIndex::directory_id(const std::filesystem::path& dir)
+{
+    if (last_dir_ != UINT32_MAX && dirs_[last_dir_] == dir) {
+        return last_dir_;
+    }
+    auto [it, inserted] = dir_ids_.try_emplace(dir.native(), static_cast<uint32_t>(dirs_.size()));
+    if (inserted) {
+        dirs_.push_back(dir);
+    }
+    last_dir_ = it->second;
+    return last_dir_;
+}
+
+void PathIndex::add(const std::filesystem::path& file_path)
+{
+    add(directory_id(file_path.parent_path()), file_path.filename().string());
+}
+
+void PathIndex::add(uint32_t dir, std::string_view name)
+{
+    dir_of_.push_back(dir);
+    name_offset_.push_back(static_cast<uint32_t>(names_.size()));
+    names_ += name;
+    names_.push_back('\0');
+}
+
+size_t PathIndex::name_end(uint32_t id) const
+{
+    // -1: esclude il terminatore '\0'
+    return (id + 1 < name_offset_.size() ? name_offset_[id + 1] : names_.size()) - 1;
+}
+
+std::string_view PathIndex::name(uint32_t id) const
+{
+    const size_t begin = name_offset_[id];
+    return std::string_view(names_.data() + begin, name_end(id) - begin);
+}
+
+std::filesystem::path PathIndex::path(uint32_t id) const
+{
+    return dirs_[dir_of_[id]] / std::filesystem::path(name(id));
+}
+
+// Gli hit arrivano in ordine crescente: ricerca esponenziale a partire
+// dall'ultimo id trovato invece di una binaria su tutto l'array.
+uint32_t PathIndex::id_at_offset(size_t blob_pos, uint32_t from) const
+{
+    const uint32_t target = static_cast<uint32_t>(blob_pos);
+    size_t lo = from, step = 1;
+    size_t hi = lo + step;
+    while (hi < name_offset_.size() && name_offset_[hi] <= target) {
+        lo = hi;
+        step *= 2;
+        hi = lo + step;
+    }
+    hi = std::min(hi, name_offset_.size());
+    auto it = std::upper_bound(name_offset_.begin() + lo, name_offset_.begin() + hi, target);
+    return static_cast<uint32_t>((it - name_offset_.begin()) - 1);
+}
+
+std::vector<uint32_t> PathIndex::query(std::string_view pattern, size_t limit) const
+{
+    std::vector<uint32_t> hits;
+    if (empty() || pattern.empty()) return hits;
+
+    const std::string folded = fold_copy(pattern);
+    const bool is_glob = folded.find_first_of("*?") != std::string::npos;
+
+    // Per un glob si cerca nel blob il pezzo letterale più lungo e si
+    // verifica il glob completo solo sui nomi candidati. L'estensione finale
+    // (".uasset") è in quasi tutti i nomi: si usa solo se non c'è altro.
+    std::string_view literal = folded;
+    if (is_glob) {
+        literal = {};
+        std::string_view extension;
+        size_t start = 0;
+        while (start <= folded.size()) {
+            size_t end = folded.find_first_of("*?", start);
+            if (end == std::string::npos) end = folded.size();
+            const std::string_view piece = std::string_view(folded).substr(start, end - start);
+            if (end == folded.size() && !piece.empty() && piece.front() == '.') {
+                extension = piece;
+            } else if (piece.size() > literal.size()) {
+                literal = piece;
+            }
+            start = end + 1;
+        }
+        if (literal.empty()) literal = extension;
+    }
+
+    auto accept = [&](uint32_t id) {
+        if (is_glob && !glob_match(name(id), folded)) return false;
+        hits.push_back(id);
+        return limit != 0 && hits.size() >= limit;
+    };
+
+    if (literal.empty()) {
+        // glob senza parti letterali ("*", "?.*"): controlla tutti i nomi
+        for (uint32_t id = 0; id < size(); ++id) {
+            if (accept(id)) break;
+        }
+        return hits;
+    }
+
+    size_t pos = 0;
+    uint32_t id = 0;
+    while ((pos = find_folded(names_.data(), names_.size(), pos, literal)) != std::string_view::npos) {
+        id = id_at_offset(pos, id);
+        if (accept(id)) break;
+        pos = name_end(id) + 1; // un solo hit per nome: salta al nome successivo
+    }
+    return hits;
+}
+
+size_t PathIndex::memory_usage() const
+{
+    size_t bytes = names_.capacity() +
+                   dir_of_.capacity() * sizeof(uint32_t) +
+                   name_offset_.capacity() * sizeof(uint32_t);
+    for (const auto& d : dirs_) {
+        bytes += sizeof(d) + d.native().capacity() * sizeof(std::filesystem::path::value_type);
+    }
+    return bytes;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Indice compatto dei file raccolti dal walk, per la ricerca "solo nome".
+//
+// Invece di un std::filesystem::path per file tiene una tabella delle
+// directory e un unico blob con tutti i nomi separati da '\0', più l'offset
+// di ogni nome e l'id della sua directory. Una query scorre il blob in modo
+// lineare (SSE2 dove disponibile) e ricostruisce il path completo solo per
+// i file trovati.
+class PathIndex
+{
+public:
+    void clear();
+    void reserve(size_t file_count);
+
+    void add(const std::filesystem::path &file_path);
+    // Variante per chi ha già le directory separate dai nomi (FileTable)
+    uint32_t add_directory(const std::filesystem::path &dir) { return directory_id(dir); }
+    void add(uint32_t dir, std::string_view name);
+
+    size_t size() const { return dir_of_.size(); }
+    bool empty() const { return dir_of_.empty(); }
+
+    std::string_view name(uint32_t id) const;
+    std::filesystem::path path(uint32_t id) const;
+
+    // Case-insensitive. Un pattern con '*' o '?' è un glob sul nome intero,
+    // altrimenti è una substring. limit == 0: nessun limite.
+    std::vector<uint32_t> query(std::string_view pattern, size_t limit = 0) const;
+
+    size_t memory_usage() const;
+
+private:
+    uint32_t directory_id(const std::filesystem::path &dir);
+    uint32_t id_at_offset(size_t blob_pos, uint32_t from) const;
+    size_t name_end(uint32_t id) const;
+
+    std::vector<std::filesystem::path> dirs_;   // tabella directory
+    std::unordered_map<std::filesystem::path::string_type, uint32_t> dir_ids_;
+    uint32_t last_dir_ = UINT32_MAX;            // i file arrivano raggruppati per directory
+
+    std::vector<uint32_t> dir_of_;              // per file: id directory
+    std::vector<uint32_t> name_offset_;         // per file: inizio del nome in names_
+    std::string names_;                         // "Nome1\0Nome2\0..."
+};
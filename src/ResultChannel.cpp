@@ -0,0 +1,53 @@
+#include "ResultChannel.h"
+#include <algorithm>
+
+ResultChannel::ResultChannel(size_t capacity) : capacity_(std::max<size_t>(capacity, 1))
+{
+}
+
+bool ResultChannel::push(const SearchResult& result)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this] { return queue_.size() < capacity_ || cancelled_; });
+    if (cancelled_) {
+        return false;
+    }
+    queue_.push_back(result);
+    not_empty_.notify_one();
+    return true;
+}
+
+bool ResultChannel::pop_batch(std::vector<SearchResult>& out, size_t max, std::chrono::milliseconds max_wait)
+{
+    out.clear();
+    // Con una coda più piccola del batch si aspetterebbe per sempre
+    const size_t wanted = std::clamp<size_t>(max, 1, capacity_);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this] { return !queue_.empty() || finished_; });
+    not_empty_.wait_for(lock, max_wait, [this, wanted] { return queue_.size() >= wanted || finished_; });
+
+    const size_t count = std::min(max, queue_.size());
+    out.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        out.push_back(std::move(queue_.front()));
+        queue_.pop_front();
+    }
+    not_full_.notify_all();
+    return !out.empty();
+}
+
+void ResultChannel::finish()
+{
+    std::scoped_lock<std::mutex> lock(mutex_);
+    finished_ = true;
+    not_empty_.notify_all();
+}
+
+void ResultChannel::cancel()
+{
+    std::scoped_lock<std::mutex> lock(mutex_);
+    cancelled_ = true;
+    queue_.clear();
+    not_full_.notify_all();
+}
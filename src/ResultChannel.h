@@ -0,0 +1,38 @@
+#pragma once
+
+#include "SearchEngine.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// Coda limitata tra i worker di una ricerca (produttori) e un consumatore
+// che chiede i risultati a batch. A coda piena push() blocca il worker:
+// la ricerca rallenta al passo del consumatore invece di accumulare memoria.
+class ResultChannel
+{
+public:
+    explicit ResultChannel(size_t capacity);
+
+    // false se il consumatore ha rinunciato (cancel): il risultato è scartato
+    bool push(const SearchResult &result);
+
+    // Aspetta max risultati (o la fine della ricerca); dopo max_wait si
+    // accontenta di quelli che ci sono, così i primi arrivano subito.
+    // false quando la ricerca è finita e la coda è vuota.
+    bool pop_batch(std::vector<SearchResult> &out, size_t max,
+                   std::chrono::milliseconds max_wait = std::chrono::milliseconds(50));
+
+    void finish(); // produttori: ricerca terminata
+    void cancel(); // consumatore: non leggerà più
+
+private:
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::deque<SearchResult> queue_;
+    const size_t capacity_;
+    bool finished_ = false;
+    bool cancelled_ = false;
+};
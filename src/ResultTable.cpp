@@ -0,0 +1,330 @@
+#include "ResultTable.h"
+#include <algorithm>
+#include <cctype>
+#include <future>
+#include <iterator>
+#include <numeric>
+#include <thread>
+
+// Primi 8 caratteri (già in minuscolo), il primo nel byte più alto:
+// l'ordine degli interi è quello alfabetico dei prefissi
+static uint64_t prefix_key(std::string_view lower)
+{
+    uint64_t key = 0;
+    for (size_t i = 0; i < 8; ++i)
+    {
+        key = (key << 8) | (i < lower.size() ? static_cast<unsigned char>(lower[i]) : 0u);
+    }
+    return key;
+}
+
+ResultTable::ResultTable() : seen_(0, NameHash{this}, NameEqual{this})
+{
+}
+
+void ResultTable::set_roots(const std::vector<std::filesystem::path> &roots)
+{
+    root_labels_.clear();
+    root_paths_.clear();
+    for (const auto &root : roots)
+    {
+        // "Game/Content", "MyPlugin/Content": basta a distinguere le root di default
+        const std::filesystem::path clean = root.lexically_normal();
+        std::filesystem::path label = clean.filename();
+        if (label.empty()) // path con '/' finale
+        {
+            label = clean.parent_path().filename();
+        }
+        else if (clean.has_parent_path() && !clean.parent_path().filename().empty())
+        {
+            label = clean.parent_path().filename() / label;
+        }
+        root_labels_.push_back(label.generic_string());
+        root_paths_.push_back(root.string());
+    }
+
+    std::vector<uint32_t> by_label(root_labels_.size());
+    std::iota(by_label.begin(), by_label.end(), 0u);
+    std::stable_sort(by_label.begin(), by_label.end(),
+                     [this](uint32_t a, uint32_t b) { return root_labels_[a] < root_labels_[b]; });
+    root_ranks_.assign(by_label.size(), 0);
+    for (uint32_t rank = 0; rank < by_label.size(); ++rank)
+    {
+        root_ranks_[by_label[rank]] = rank;
+    }
+}
+
+bool ResultTable::add(const SearchResult &result)
+{
+    // Il nome va nel blob prima del controllo: il set confronta righe
+    const std::string name = result.file_path.filename().string();
+    const Row row = static_cast<Row>(files_.size());
+    const size_t offset = names_.size();
+    names_.append(name).push_back('\0');
+    files_.push_back(static_cast<uint32_t>(offset));
+    if (!seen_.insert(row).second)
+    {
+        files_.pop_back();
+        names_.resize(offset);
+        return false;
+    }
+    std::transform(name.begin(), name.end(), std::back_inserter(lower_names_),
+                   [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+    lower_names_.push_back('\0');
+
+    roots_.push_back(result.root);
+    sizes_.push_back(result.size);
+    mtimes_.push_back(result.mtime);
+    match_counts_.push_back(static_cast<uint32_t>(result.match_count));
+    scores_.push_back(result.score);
+    edit_distances_.push_back(static_cast<uint8_t>(result.edit_distance));
+    name_keys_.push_back(prefix_key(lower_name(row)));
+    char_masks_.push_back(FuzzyPattern::char_mask(lower_name(row)));
+    filter_scores_.push_back(0);
+    return true;
+}
+
+void ResultTable::clear()
+{
+    seen_.clear();
+    names_.clear();
+    lower_names_.clear();
+    files_.clear();
+    roots_.clear();
+    sizes_.clear();
+    mtimes_.clear();
+    match_counts_.clear();
+    scores_.clear();
+    edit_distances_.clear();
+    name_keys_.clear();
+    char_masks_.clear();
+    filter_scores_.clear();
+}
+
+std::string_view ResultTable::name(Row row) const
+{
+    const char *begin = names_.data() + files_[row];
+    return std::string_view(begin);
+}
+
+std::string_view ResultTable::lower_name(Row row) const
+{
+    const char *begin = lower_names_.data() + files_[row];
+    return std::string_view(begin);
+}
+
+const std::string &ResultTable::root_label(uint32_t root) const
+{
+    static const std::string unknown;
+    return root < root_labels_.size() ? root_labels_[root] : unknown;
+}
+
+const std::string &ResultTable::root_path(uint32_t root) const
+{
+    static const std::string unknown;
+    return root < root_paths_.size() ? root_paths_[root] : unknown;
+}
+
+bool ResultTable::name_contains(Row row, std::string_view filter_lower) const
+{
+    return lower_name(row).find(filter_lower) != std::string_view::npos;
+}
+
+// Thread per i lavori a blocchi: la GUI li lancia sotto il lock dei risultati
+static size_t parallel_parts()
+{
+    return std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 8);
+}
+
+// fn(i) per i in [0, tasks), in parallelo se più di uno
+template <class Fn>
+static void run_parallel(size_t tasks, Fn fn)
+{
+    if (tasks <= 1)
+    {
+        if (tasks == 1) fn(size_t{0});
+        return;
+    }
+    std::vector<std::future<void>> running;
+    for (size_t i = 0; i < tasks; ++i)
+    {
+        running.emplace_back(std::async(std::launch::async, [&fn, i]() { fn(i); }));
+    }
+    for (auto &task : running)
+    {
+        task.get();
+    }
+}
+
+std::vector<ResultTable::Row> ResultTable::fuzzy_filter(const FuzzyPattern &pattern)
+{
+    const size_t rows = size();
+    const size_t parts = rows < kParallelFilterRows ? 1 : parallel_parts();
+    std::vector<std::vector<Row>> matched(parts);
+    const uint64_t need = pattern.char_mask();
+
+    run_parallel(parts, [&](size_t part) {
+        const size_t begin = rows * part / parts;
+        const size_t end = rows * (part + 1) / parts;
+        // Prefiltro: solo AND e confronti sulla colonna, senza salti
+        // condizionali, così il compilatore lo vettorizza
+        std::vector<uint8_t> candidate(end - begin);
+        const uint64_t *masks = char_masks_.data() + begin;
+        for (size_t i = 0; i < candidate.size(); ++i)
+        {
+            candidate[i] = static_cast<uint8_t>((masks[i] & need) == need);
+        }
+        for (size_t i = 0; i < candidate.size(); ++i)
+        {
+            const Row row = static_cast<Row>(begin + i);
+            const int score = candidate[i] ? pattern.score(name(row), lower_name(row)) : FuzzyPattern::kNoMatch;
+            filter_scores_[row] = score;
+            if (score != FuzzyPattern::kNoMatch)
+            {
+                matched[part].push_back(row);
+            }
+        }
+    });
+
+    std::vector<Row> result = std::move(matched[0]);
+    for (size_t part = 1; part < parts; ++part)
+    {
+        result.insert(result.end(), matched[part].begin(), matched[part].end());
+    }
+    return result;
+}
+
+bool ResultTable::fuzzy_match(Row row, const FuzzyPattern &pattern)
+{
+    const uint64_t need = pattern.char_mask();
+    const int score = (char_masks_[row] & need) == need ? pattern.score(name(row), lower_name(row))
+                                                        : FuzzyPattern::kNoMatch;
+    filter_scores_[row] = score;
+    return score != FuzzyPattern::kNoMatch;
+}
+
+template <class T>
+static int three_way(T a, T b)
+{
+    return (a > b) - (a < b);
+}
+
+static int compare_names(const ResultTable &table, ResultTable::Row a, ResultTable::Row b)
+{
+    if (const int by_prefix = three_way(table.name_key(a), table.name_key(b)); by_prefix != 0)
+    {
+        return by_prefix;
+    }
+    return table.lower_name(a).compare(table.lower_name(b));
+}
+
+// Chiama fn con il "less" della colonna: un tipo per colonna, così il
+// confronto si inlinea nel sort. A pari chiave decide l'ordine di arrivo.
+template <class Fn>
+static void with_less(const ResultTable &table, ResultOrder order, Fn &&fn)
+{
+    auto by = [&](auto compare) {
+        fn([&table, compare, descending = order.descending](ResultTable::Row a, ResultTable::Row b) {
+            const int c = compare(table, a, b);
+            if (c != 0)
+            {
+                return descending ? c > 0 : c < 0;
+            }
+            return a < b;
+        });
+    };
+    using Row = ResultTable::Row;
+    switch (order.column)
+    {
+    case ResultColumn::Name:
+        by(compare_names);
+        break;
+    case ResultColumn::Root:
+        by([](const ResultTable &t, Row a, Row b) { return three_way(t.root_rank(t.root(a)), t.root_rank(t.root(b))); });
+        break;
+    case ResultColumn::Size:
+        by([](const ResultTable &t, Row a, Row b) { return three_way(t.file_size(a), t.file_size(b)); });
+        break;
+    case ResultColumn::Modified:
+        by([](const ResultTable &t, Row a, Row b) { return three_way(t.mtime(a), t.mtime(b)); });
+        break;
+    case ResultColumn::Matches:
+        by([](const ResultTable &t, Row a, Row b) { return three_way(t.match_count(a), t.match_count(b)); });
+        break;
+    case ResultColumn::Score:
+        by([](const ResultTable &t, Row a, Row b) { return three_way(t.score(a), t.score(b)); });
+        break;
+    case ResultColumn::Fuzzy:
+        by([](const ResultTable &t, Row a, Row b) { return three_way(t.filter_score(a), t.filter_score(b)); });
+        break;
+    }
+}
+
+// Blocchi ordinati in parallelo, poi fusi a coppie (anche le fusioni dello
+// stesso livello in parallelo)
+template <class Less>
+static void parallel_sort(std::vector<ResultTable::Row> &rows, Less less)
+{
+    const size_t parts = parallel_parts();
+    if (rows.size() < SortedResults::kParallelSortRows || parts == 1)
+    {
+        std::sort(rows.begin(), rows.end(), less);
+        return;
+    }
+
+    std::vector<size_t> bounds(parts + 1);
+    for (size_t i = 0; i <= parts; ++i)
+    {
+        bounds[i] = rows.size() * i / parts;
+    }
+    run_parallel(parts, [&](size_t i) {
+        std::sort(rows.begin() + bounds[i], rows.begin() + bounds[i + 1], less);
+    });
+    for (size_t width = 1; width < parts; width *= 2)
+    {
+        const size_t merges = (parts - width + 2 * width - 1) / (2 * width);
+        run_parallel(merges, [&](size_t m) {
+            const size_t i = m * 2 * width;
+            const size_t first = bounds[i];
+            const size_t middle = bounds[i + width];
+            const size_t last = bounds[std::min(i + 2 * width, parts)];
+            std::inplace_merge(rows.begin() + first, rows.begin() + middle, rows.begin() + last, less);
+        });
+    }
+}
+
+void SortedResults::set_order(const ResultTable &table, ResultOrder order)
+{
+    order_ = order;
+    sort_all(table);
+}
+
+void SortedResults::assign(const ResultTable &table, std::vector<ResultTable::Row> rows, ResultOrder order)
+{
+    order_ = order;
+    rows_ = std::move(rows);
+    pending_.clear();
+    sort_all(table);
+}
+
+void SortedResults::sort_all(const ResultTable &table)
+{
+    rows_.insert(rows_.end(), pending_.begin(), pending_.end());
+    pending_.clear();
+    with_less(table, order_, [&](auto less) { parallel_sort(rows_, less); });
+}
+
+void SortedResults::merge_pending(const ResultTable &table)
+{
+    if (pending_.empty())
+    {
+        return;
+    }
+    with_less(table, order_, [&](auto less) {
+        std::sort(pending_.begin(), pending_.end(), less);
+        const size_t middle = rows_.size();
+        rows_.insert(rows_.end(), pending_.begin(), pending_.end());
+        std::inplace_merge(rows_.begin(), rows_.begin() + middle, rows_.end(), less);
+    });
+    pending_.clear();
+}
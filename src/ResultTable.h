@@ -0,0 +1,154 @@
+#pragma once
+
+#include "FuzzyMatch.h"
+#include "SearchEngine.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// Risultati mostrati dalla GUI, per colonne (structure of arrays).
+//
+// Una riga è un indice: nome (offset nel blob dei nomi, l'id del file),
+// root, size, mtime, occorrenze, errori e punteggio stanno in array separati.
+// Filtro, ordinamento ed export scorrono solo le colonne che usano, contigue
+// in memoria, invece di saltare tra struct con path e stringhe sull'heap.
+// Un nome compare una volta sola: le copie dello stesso asset in cartelle
+// diverse sono una riga.
+class ResultTable
+{
+public:
+    using Row = uint32_t;
+
+    static constexpr size_t kParallelFilterRows = 20000; // sotto, il filtro fuzzy gira su un thread
+
+    ResultTable();
+    ResultTable(const ResultTable &) = delete;
+    ResultTable &operator=(const ResultTable &) = delete;
+
+    // Root della ricerca, nell'ordine di SearchRequest::paths
+    void set_roots(const std::vector<std::filesystem::path> &roots);
+    // false se un file con lo stesso nome è già in tabella
+    bool add(const SearchResult &result);
+    void clear();
+
+    size_t size() const { return scores_.size(); }
+    bool empty() const { return scores_.empty(); }
+
+    // Terminato da '\0': si passa direttamente a ImGui
+    std::string_view name(Row row) const;
+    uint32_t root(Row row) const { return roots_[row]; }
+    uint64_t file_size(Row row) const { return sizes_[row]; }
+    int64_t mtime(Row row) const { return mtimes_[row]; } // secondi Unix, 0 = non noto
+    uint32_t match_count(Row row) const { return match_counts_[row]; }
+    int score(Row row) const { return scores_[row]; }
+    uint32_t edit_distance(Row row) const { return edit_distances_[row]; } // 0 = occorrenza esatta
+
+    // Nome breve della root (ultime due cartelle) e path completo
+    const std::string &root_label(uint32_t root) const;
+    const std::string &root_path(uint32_t root) const;
+
+    // Chiavi di ordinamento, calcolate una volta per riga/root: il nome in
+    // minuscolo, i suoi primi 8 caratteri come intero big-endian (la maggior
+    // parte dei confronti finisce lì) e la posizione della root in ordine
+    // alfabetico di etichetta
+    std::string_view lower_name(Row row) const;
+    uint64_t name_key(Row row) const { return name_keys_[row]; }
+    uint32_t root_rank(uint32_t root) const { return root < root_ranks_.size() ? root_ranks_[root] : root; }
+
+    // Il nome contiene filter_lower, senza distinguere maiuscole
+    bool name_contains(Row row, std::string_view filter_lower) const;
+
+    // Filtro fuzzy su tutte le righe: prefiltro sulle maschere dei caratteri
+    // (un AND per riga, vettorizzato), poi punteggio dei candidati, a blocchi
+    // in parallelo. Ritorna le righe che corrispondono, in ordine di arrivo;
+    // il punteggio resta in filter_score() fino al prossimo filtro.
+    std::vector<Row> fuzzy_filter(const FuzzyPattern &pattern);
+    // Lo stesso per una riga sola (risultati in arrivo durante la ricerca)
+    bool fuzzy_match(Row row, const FuzzyPattern &pattern);
+    int filter_score(Row row) const { return filter_scores_[row]; }
+
+private:
+    // Dedup sul nome: il set tiene righe, hash e confronto leggono il blob
+    struct NameHash
+    {
+        const ResultTable *table;
+        size_t operator()(Row row) const { return std::hash<std::string_view>{}(table->name(row)); }
+    };
+    struct NameEqual
+    {
+        const ResultTable *table;
+        bool operator()(Row a, Row b) const { return table->name(a) == table->name(b); }
+    };
+
+    std::string names_;                  // "Nome1\0Nome2\0..."
+    std::string lower_names_;            // gli stessi in minuscolo, agli stessi offset
+    std::vector<uint32_t> files_;        // offset del nome in names_
+    std::vector<uint32_t> roots_;
+    std::vector<uint64_t> sizes_;
+    std::vector<int64_t> mtimes_;
+    std::vector<uint32_t> match_counts_;
+    std::vector<int32_t> scores_;
+    std::vector<uint8_t> edit_distances_;
+    std::vector<uint64_t> name_keys_;
+    std::vector<uint64_t> char_masks_;  // FuzzyPattern::char_mask del nome
+    std::vector<int32_t> filter_scores_; // dell'ultimo filtro fuzzy
+    std::unordered_set<Row, NameHash, NameEqual> seen_;
+
+    std::vector<std::string> root_labels_;
+    std::vector<std::string> root_paths_;
+    std::vector<uint32_t> root_ranks_;
+};
+
+// Colonne della tabella risultati; il valore è lo user id della colonna ImGui
+enum class ResultColumn : uint32_t
+{
+    Name,
+    Root,
+    Size,
+    Modified,
+    Matches,
+    Score,
+    Fuzzy, // punteggio del filtro fuzzy: non è una colonna visibile
+};
+
+struct ResultOrder
+{
+    ResultColumn column = ResultColumn::Score;
+    bool descending = true;
+};
+
+// Righe della tabella in ordine di una colonna, aggiornate in streaming.
+//
+// I risultati nuovi si accodano in pending e a ogni frame si ordinano tra
+// loro e si fondono con quelli già in vista (O(n + k log k)), invece di
+// riordinare tutto. Cambiare colonna riordina l'intera vista, in parallelo
+// oltre kParallelSortRows righe. A pari chiave resta l'ordine di arrivo.
+class SortedResults
+{
+public:
+    static constexpr size_t kParallelSortRows = 50000;
+
+    ResultOrder order() const { return order_; }
+    void set_order(const ResultTable &table, ResultOrder order);
+
+    // Visibile dopo il prossimo merge_pending
+    void insert(ResultTable::Row row) { pending_.push_back(row); }
+    void merge_pending(const ResultTable &table);
+    // Sostituisce tutte le righe (filtro cambiato) e le ordina secondo order
+    void assign(const ResultTable &table, std::vector<ResultTable::Row> rows, ResultOrder order);
+    void clear() { rows_.clear(); pending_.clear(); }
+
+    size_t size() const { return rows_.size(); }
+    bool empty() const { return rows_.empty(); }
+    ResultTable::Row operator[](size_t i) const { return rows_[i]; }
+
+private:
+    void sort_all(const ResultTable &table);
+
+    ResultOrder order_;
+    std::vector<ResultTable::Row> rows_;    // ordinate secondo order_
+    std::vector<ResultTable::Row> pending_; // arrivate dopo l'ultimo merge
+};
@@ -0,0 +1,152 @@
+#include "ScanOrder.h"
+#include <algorithm>
+#include <bit>
+#include <cctype>
+
+static std::string lower_copy(std::string s)
+{
+    std::transform(s.begin(), s.end(), s.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return s;
+}
+
+// Trigrammi distinti, al più 16: per i pattern lunghi bastano
+static std::vector<std::string> trigrams_of(const std::string &s)
+{
+    std::vector<std::string> out;
+    for (size_t i = 0; i + 3 <= s.size() && out.size() < 16; ++i) {
+        std::string t = s.substr(i, 3);
+        if (std::find(out.begin(), out.end(), t) == out.end()) {
+            out.push_back(std::move(t));
+        }
+    }
+    return out;
+}
+
+// Due query sono simili se una contiene l'altra o se condividono
+// almeno metà dei trigrammi ("WeaponBase" / "WeaponBase_C" / "weapon")
+static bool similar_queries(const std::string &a, const std::string &b)
+{
+    if (a.empty() || b.empty()) return false;
+    if (a.find(b) != std::string::npos || b.find(a) != std::string::npos) return true;
+    const auto ta = trigrams_of(a);
+    const auto tb = trigrams_of(b);
+    if (ta.empty() || tb.empty()) return false;
+    size_t common = 0;
+    for (const auto &t : ta) {
+        common += std::find(tb.begin(), tb.end(), t) != tb.end();
+    }
+    return common * 2 >= std::max(ta.size(), tb.size());
+}
+
+// FNV-1a sulle unità del path nativo: si può proseguire da una chiave
+// già calcolata
+static constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+static constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+static uint64_t fnv_append(uint64_t hash, HitHistory::NameView text)
+{
+    for (const auto c : text) {
+        hash = (hash ^ static_cast<uint64_t>(c)) * kFnvPrime;
+    }
+    return hash;
+}
+
+static bool is_separator(std::filesystem::path::value_type c)
+{
+    return c == '/' || c == std::filesystem::path::preferred_separator;
+}
+
+uint64_t HitHistory::directory_key(NameView directory)
+{
+    // "Content/" (root data con la barra) e "Content" (parent_path di un
+    // suo file) sono la stessa cartella
+    while (!directory.empty() && is_separator(directory.back())) {
+        directory.remove_suffix(1);
+    }
+    return fnv_append(kFnvOffset, directory);
+}
+
+uint64_t HitHistory::file_key(uint64_t directory_key, NameView name)
+{
+    const std::filesystem::path::value_type separator = '/';
+    return fnv_append(fnv_append(directory_key, NameView(&separator, 1)), name);
+}
+
+void HitHistory::record(const std::string &query, const std::vector<std::filesystem::path> &hits)
+{
+    if (query.empty() || hits.empty()) {
+        return;
+    }
+    Entry entry;
+    entry.query = lower_copy(query);
+    for (const auto &hit : hits) {
+        if (entry.files.size() >= kMaxHitsPerQuery) break;
+        const uint64_t dir = directory_key(hit.parent_path().native());
+        entry.files.push_back(file_key(dir, hit.filename().native()));
+        entry.dirs.push_back(dir);
+    }
+
+    std::scoped_lock<std::mutex> lock(mutex_);
+    // La stessa query ripetuta sostituisce la vecchia voce
+    entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                                  [&](const Entry &e) { return e.query == entry.query; }),
+                   entries_.end());
+    entries_.push_front(std::move(entry));
+    if (entries_.size() > kMaxQueries) {
+        entries_.pop_back();
+    }
+}
+
+HitHistory::Hints HitHistory::hints_for(const std::string &query) const
+{
+    Hints hints;
+    const std::string lower = lower_copy(query);
+    std::scoped_lock<std::mutex> lock(mutex_);
+    for (const auto &entry : entries_) {
+        if (similar_queries(entry.query, lower)) {
+            hints.files.insert(entry.files.begin(), entry.files.end());
+            hints.dirs.insert(entry.dirs.begin(), entry.dirs.end());
+        }
+    }
+    return hints;
+}
+
+void HitHistory::clear()
+{
+    std::scoped_lock<std::mutex> lock(mutex_);
+    entries_.clear();
+}
+
+ScanOrder::ScanOrder(const std::string &literal_lower, HitHistory::Hints hints)
+    : trigrams_(trigrams_of(literal_lower)), hints_(std::move(hints))
+{
+}
+
+int ScanOrder::score(std::string_view name_lower, uint64_t directory_key, uint64_t file_key,
+                     uint64_t size, bool name_match) const
+{
+    int score = 0;
+    if (name_match) {
+        score += 1000;
+    } else if (!trigrams_.empty()) {
+        // Somiglianza parziale: "Weapon_Base" per il pattern "weaponbase"
+        size_t common = 0;
+        for (const auto &t : trigrams_) {
+            common += name_lower.find(t) != std::string_view::npos;
+        }
+        score += static_cast<int>(400 * common / trigrams_.size());
+    }
+
+    if (!hints_.empty()) {
+        if (hints_.files.count(file_key)) {
+            score += 600;
+        } else if (hints_.dirs.count(directory_key)) {
+            score += 200;
+        }
+    }
+
+    // A parità, prima i file piccoli: si leggono in fretta e danno risultati prima
+    score -= 5 * static_cast<int>(std::bit_width(size));
+    return score;
+}
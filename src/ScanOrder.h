@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// Dove hanno trovato qualcosa le ultime ricerche. Una query simile (stessa
+// radice, o trigrammi in comune) probabilmente colpisce gli stessi file o
+// almeno le stesse cartelle: vale la pena aprirli per primi.
+class HitHistory
+{
+public:
+    struct Hints
+    {
+        std::unordered_set<uint64_t> files; // hash dei path con un hit
+        std::unordered_set<uint64_t> dirs;  // hash delle loro cartelle
+        bool empty() const { return files.empty() && dirs.empty(); }
+    };
+
+    static constexpr size_t kMaxQueries = 32;       // query ricordate
+    static constexpr size_t kMaxHitsPerQuery = 256; // hit ricordati per query
+
+    void record(const std::string &query, const std::vector<std::filesystem::path> &hits);
+    Hints hints_for(const std::string &query) const;
+    void clear();
+
+    // Chiavi componibili: quella di un file si calcola dalla chiave della
+    // sua cartella e dal nome, senza ricostruire il path (FileTable)
+    using NameView = std::basic_string_view<std::filesystem::path::value_type>;
+    static uint64_t directory_key(NameView directory); // separatori finali ignorati
+    static uint64_t file_key(uint64_t directory_key, NameView name);
+
+private:
+    struct Entry
+    {
+        std::string query; // in minuscolo
+        std::vector<uint64_t> files;
+        std::vector<uint64_t> dirs;
+    };
+
+    mutable std::mutex mutex_;
+    std::deque<Entry> entries_; // front = più recente
+};
+
+// Punteggio "quanto è probabile che questo file contenga il pattern",
+// calcolato dal nome, dalla storia e dalla size, senza aprire il file.
+// Serve solo a decidere l'ordine: la scansione resta completa.
+class ScanOrder
+{
+public:
+    ScanOrder() = default;
+    // literal_lower vuoto per i pattern regex: niente similarità parziale
+    ScanOrder(const std::string &literal_lower, HitHistory::Hints hints);
+
+    // La storia conta solo se ha hit per query simili: senza, le chiavi dei
+    // path non servono e il chiamante può passare 0
+    bool uses_history() const { return !hints_.empty(); }
+
+    // name_lower: nome del file in minuscolo; name_match: il nome contiene
+    // già il pattern (calcolato dal motore); chiavi di HitHistory
+    int score(std::string_view name_lower, uint64_t directory_key, uint64_t file_key,
+              uint64_t size, bool name_match) const;
+
+private:
+    std::vector<std::string> trigrams_;
+    HitHistory::Hints hints_;
+};
@@ -0,0 +1,80 @@
+#include "SearchArena.h"
+#include <cstdint>
+#include <new>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+// Dimensione di una huge page x86-64/arm64 con pagine base da 4 KB
+static constexpr size_t kHugePage = 2 * 1024 * 1024;
+
+static size_t round_up(size_t bytes, size_t to)
+{
+    return (bytes + to - 1) / to * to;
+}
+
+SearchArena::SearchArena(size_t initial_bytes)
+    : block_size_(round_up(initial_bytes == 0 ? kHugePage : initial_bytes, kHugePage)),
+      monotonic_(allocate_block(), block_size_, std::pmr::new_delete_resource())
+{
+}
+
+SearchArena::~SearchArena()
+{
+    monotonic_.release();
+    if (mapping_ == nullptr) {
+        ::operator delete(block_);
+        return;
+    }
+#ifdef _WIN32
+    VirtualFree(mapping_, 0, MEM_RELEASE);
+#else
+    munmap(mapping_, mapping_size_);
+#endif
+}
+
+void* SearchArena::allocate_block()
+{
+#ifdef _WIN32
+    // Le large page vogliono SeLockMemoryPrivilege: pagine normali, ma
+    // riservate una volta sola e mai toccate finché non servono
+    mapping_ = VirtualAlloc(nullptr, block_size_, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    mapping_size_ = block_size_;
+    block_ = mapping_;
+#else
+    // Un huge page in più per poter allineare il blocco a 2 MB
+    mapping_size_ = block_size_ + kHugePage;
+    void* mapped = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapped != MAP_FAILED) {
+        mapping_ = mapped;
+        const auto base = reinterpret_cast<uintptr_t>(mapped);
+        block_ = reinterpret_cast<void*>(round_up(base, kHugePage));
+#ifdef MADV_HUGEPAGE
+        madvise(block_, block_size_, MADV_HUGEPAGE);
+#endif
+    }
+#endif
+    if (block_ == nullptr) {
+        mapping_ = nullptr;
+        block_ = ::operator new(block_size_);
+    }
+    return block_;
+}
+
+void SearchArena::reset()
+{
+    std::scoped_lock<std::mutex> lock(mutex_);
+    monotonic_.release(); // torna al primo blocco, i successivi vanno all'heap
+}
+
+void* SearchArena::LockedResource::do_allocate(size_t bytes, size_t alignment)
+{
+    std::scoped_lock<std::mutex> lock(arena_.mutex_);
+    return arena_.monotonic_.allocate(bytes, alignment);
+}
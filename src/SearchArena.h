@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+
+// Memoria delle strutture che vivono quanto una ricerca (liste di file da
+// scandire, chiavi di ordinamento, mappe del delta snapshot, path virtuali
+// dei .pak, path dei file in coda su un verdetto): allocazioni a bump
+// pointer, nessun free per oggetto, e a fine ricerca un solo reset() che
+// rende tutto.
+//
+// Il primo blocco è riservato una volta per motore e riusato ad ogni
+// ricerca; su Linux è allineato a 2 MB e chiesto in huge page
+// (MADV_HUGEPAGE), così le liste da milioni di puntatori non pagano un TLB
+// miss ogni 4 KB. Oltre il primo blocco si prosegue sull'heap a blocchi
+// crescenti. Thread-safe: più root si scandiscono in parallelo.
+class SearchArena
+{
+public:
+    explicit SearchArena(size_t initial_bytes = 8 * 1024 * 1024);
+    ~SearchArena();
+
+    SearchArena(const SearchArena &) = delete;
+    SearchArena &operator=(const SearchArena &) = delete;
+
+    std::pmr::memory_resource *resource() { return &locked_; }
+
+    // Rende tutta la memoria della ricerca: chi la usava non deve più esistere
+    void reset();
+
+private:
+    // monotonic_buffer_resource non è thread-safe: un lock per allocazione,
+    // che comunque è un incremento di puntatore
+    class LockedResource : public std::pmr::memory_resource
+    {
+    public:
+        explicit LockedResource(SearchArena &arena) : arena_(arena) {}
+
+    private:
+        void *do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void *, size_t, size_t) override {}
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+        SearchArena &arena_;
+    };
+
+    void *allocate_block(); // block_size_ byte, chiamata una volta dal costruttore
+
+    size_t block_size_ = 0;
+    void *block_ = nullptr;       // primo blocco, riusato tra le ricerche
+    void *mapping_ = nullptr;     // base della mappatura (il blocco è allineato dentro)
+    size_t mapping_size_ = 0;
+
+    std::mutex mutex_;
+    std::pmr::monotonic_buffer_resource monotonic_;
+    LockedResource locked_{*this};
+};
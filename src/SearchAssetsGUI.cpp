@@ -6,6 +6,8 @@
 #include <algorithm>
 #include <sstream>
 #include <chrono>
+#include <cstdio>
+#include <ctime>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -14,9 +16,46 @@
 #include <sys/wait.h>
 #endif
 
+// "12.3 KB", "4.1 MB"
+static void format_size(uint64_t bytes, char *out, size_t out_size)
+{
+    if (bytes < 1024 * 1024)
+        snprintf(out, out_size, "%.1f KB", bytes / 1024.0);
+    else
+        snprintf(out, out_size, "%.1f MB", bytes / (1024.0 * 1024.0));
+}
+
+// Secondi Unix → "2024-05-31 18:02", ora locale
+static void format_mtime(int64_t seconds, char *out, size_t out_size)
+{
+    const std::time_t time = static_cast<std::time_t>(seconds);
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &time);
+#else
+    localtime_r(&time, &local);
+#endif
+    std::strftime(out, out_size, "%Y-%m-%d %H:%M", &local);
+}
+
+static std::string to_lower_copy(const char *text)
+{
+    std::string lower = text;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    return lower;
+}
+
 SearchAssetsGUI::SearchAssetsGUI(GLFWwindow* window) : glfw_window_(window)
 {
     search_engine_ = std::make_unique<SearchEngine>();
+    snprintf(extension_filter_, sizeof(extension_filter_), "%s", FileFilter::kDefaultExtensions);
+    snprintf(exclude_filter_, sizeof(exclude_filter_), "%s", FileFilter::kDefaultExclude);
+
+    // Lista file dell'ultima sessione: prima ricerca senza walk a freddo
+    // e type-ahead sui nomi disponibile da subito
+    search_engine_->set_snapshot_dir(SearchEngine::default_snapshot_dir());
+    apply_file_filter();
+    search_engine_->preload_snapshots(build_search_paths());
     // Initialize filtered results as empty
     filtered_result_lines_.clear();
 
@@ -34,9 +73,10 @@ SearchAssetsGUI::SearchAssetsGUI(GLFWwindow* window) : glfw_window_(window)
 
 SearchAssetsGUI::~SearchAssetsGUI()
 {
-    if (search_engine_)
+    stop_current_search();
+    if (search_thread_.joinable())
     {
-        search_engine_->stop_search();
+        search_thread_.join();
     }
 }
 
@@ -126,6 +166,22 @@ void SearchAssetsGUI::render_search_panel()
         // Enter key pressed, start search
         perform_search();
     }
+    else if (names_only_ && ImGui::IsItemEdited())
+    {
+        // Solo nomi: risultati istantanei mentre si scrive
+        update_name_typeahead();
+    }
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::BeginTooltip();
+        ImGui::Text("Text, regex, or a query on file contents:");
+        ImGui::Text("  DamageComponent AND Shield AND NOT Deprecated");
+        ImGui::Text("  (word:Health OR re:\"Shield(s|Component)\") NOT Deprecated");
+        ImGui::Text("AND, OR, NOT in capitals; terms side by side mean AND");
+        ImGui::Text("word: whole word, re: regex, lit: plain text; quote terms with spaces or ( )");
+        ImGui::Text("Results must contain a term that is not negated: 'NOT Deprecated' alone is rejected");
+        ImGui::EndTooltip();
+    }
 
     // Row 2: Path and Options
     ImGui::Text("Path:");
@@ -155,6 +211,68 @@ void SearchAssetsGUI::render_search_panel()
         ImGui::EndTooltip();
     }
 
+    // Cache in memoria dei file scanditi (0 = off)
+    ImGui::SameLine();
+    static const char* kCacheLabels[] = {"Cache: Off", "Cache: 64 MB", "Cache: 256 MB", "Cache: 1 GB"};
+    static const size_t kCacheMB[] = {0, 64, 256, 1024};
+    ImGui::SetNextItemWidth(120);
+    if (ImGui::Combo("##ContentCache", &content_cache_choice_, kCacheLabels, IM_ARRAYSIZE(kCacheLabels)))
+    {
+        search_engine_->set_content_cache_budget(kCacheMB[content_cache_choice_] * 1024 * 1024);
+    }
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::BeginTooltip();
+        ImGui::Text("Keep recently scanned files in memory");
+        ImGui::Text("Repeated searches skip the disk (useful on network drives)");
+        ImGui::EndTooltip();
+    }
+
+    ImGui::SameLine();
+    ImGui::Checkbox("Use Daemon", &use_daemon_);
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::BeginTooltip();
+        ImGui::Text("Send searches to a running 'SearchAssetsV2 --daemon'");
+        ImGui::Text("Its index and caches stay warm across windows and scripts");
+        ImGui::Text("Falls back to a local search if no daemon is running");
+        ImGui::EndTooltip();
+    }
+
+    ImGui::SameLine();
+    ImGui::Checkbox("Disk Order", &disk_order_);
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::BeginTooltip();
+        ImGui::Text("For spinning disks and network shares");
+        ImGui::Text("Reads files in the order they are stored on disk, two at a time per drive,");
+        ImGui::Text("and asks the OS to read the next 16 files ahead");
+        ImGui::Text("Overrides Likely First");
+        ImGui::EndTooltip();
+    }
+
+    ImGui::SameLine();
+    ImGui::Checkbox("Auto Threads", &adaptive_threads_);
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::BeginTooltip();
+        ImGui::Text("Adjust the number of search threads to the measured throughput");
+        ImGui::Text("Fewer threads on HDDs and network shares, all of them on NVMe");
+        ImGui::Text("The best setting is remembered per drive for the next search");
+        ImGui::EndTooltip();
+    }
+
+    ImGui::SameLine();
+    ImGui::Checkbox("Background", &background_);
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::BeginTooltip();
+        ImGui::Text("Lowest CPU and disk priority, for long scans left running while you work");
+        ImGui::Text("Pauses while the system is busy or a search runs in another window or from the command line");
+        ImGui::Text("Start Search stays available: a new search in this window stops this one");
+        ImGui::EndTooltip();
+    }
+
     // Checkboxes - Second row
     ImGui::Checkbox("Remove UE Prefixes", &remove_unreal_prefixes_);
     if (ImGui::IsItemHovered())
@@ -177,6 +295,103 @@ void SearchAssetsGUI::render_search_panel()
         ImGui::EndTooltip();
     }
 
+    ImGui::SameLine();
+    ImGui::Checkbox("Match Case", &match_case_);
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::BeginTooltip();
+        ImGui::Text("Distinguish upper and lower case in file contents");
+        ImGui::Text("Example: 'Weapon' will NOT match 'weapon'");
+        ImGui::EndTooltip();
+    }
+
+    // Ricerca approssimata: lettere mancanti, in più o sbagliate
+    ImGui::SameLine();
+    static const char* kTypoLabels[] = {"Exact", "1 typo", "2 typos", "3 typos"};
+    ImGui::SetNextItemWidth(80);
+    ImGui::Combo("##MaxEdits", &max_edits_choice_, kTypoLabels, IM_ARRAYSIZE(kTypoLabels));
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::BeginTooltip();
+        ImGui::Text("Also find the pattern with a few typos in file contents");
+        ImGui::Text("Example: 'Charachter' with 1 typo finds 'Character'");
+        ImGui::Text("Plain text patterns only; ignores Match Whole Word");
+        ImGui::Text("Short patterns allow fewer typos");
+        ImGui::EndTooltip();
+    }
+
+    ImGui::SameLine();
+    ImGui::Checkbox("Names Only", &names_only_);
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::BeginTooltip();
+        ImGui::Text("Search file names only, without opening the files");
+        ImGui::Text("Supports wildcards: 'BP_*Weapon*', 'T_???_D'");
+        ImGui::Text("Results update as you type once the folder has been indexed");
+        ImGui::EndTooltip();
+    }
+
+    ImGui::SameLine();
+    ImGui::Checkbox("Search Paks", &search_paks_);
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::BeginTooltip();
+        ImGui::Text("Also search inside .pak archives (cooked builds)");
+        ImGui::Text("Results are shown as Archive.pak/Game/Content/...");
+        ImGui::Text("Encrypted and Oodle-compressed entries are skipped");
+        ImGui::EndTooltip();
+    }
+
+    // Limite ai risultati: raggiunto, la ricerca si ferma subito
+    ImGui::SameLine();
+    static const char* kLimitLabels[] = {"All results", "First hit", "First 50", "First 500"};
+    ImGui::SetNextItemWidth(110);
+    ImGui::Combo("##ResultLimit", &result_limit_choice_, kLimitLabels, IM_ARRAYSIZE(kLimitLabels));
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::BeginTooltip();
+        ImGui::Text("Stop the whole search once this many results are found");
+        ImGui::Text("'First hit' answers \"is this name used anywhere?\" quickly");
+        ImGui::EndTooltip();
+    }
+
+    ImGui::SameLine();
+    ImGui::Checkbox("Likely First", &prioritize_likely_);
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::BeginTooltip();
+        ImGui::Text("Scan the most promising files first: names similar to the pattern,");
+        ImGui::Text("files and folders that matched similar searches, small files");
+        ImGui::Text("The first hits come back sooner; the total time does not change");
+        ImGui::EndTooltip();
+    }
+
+    // Row 4: regole del walk (file e cartelle esclusi non vengono mai aperti)
+    ImGui::AlignTextToFramePadding();
+    ImGui::Text("Ext:");
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(130);
+    ImGui::InputTextWithHint("##ExtFilter", "all", extension_filter_, sizeof(extension_filter_));
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Only these extensions, separated by ';'\nEmpty = all files");
+    ImGui::SameLine();
+    ImGui::Text("Exclude:");
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(170);
+    ImGui::InputTextWithHint("##ExcludeFilter", "none", exclude_filter_, sizeof(exclude_filter_));
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Folders and files to skip, separated by ';'\n"
+                          "A name skips any folder/file with that name, 'a/b/**' a relative path\n"
+                          "Example: Developers;Collections;*_Old*");
+    ImGui::SameLine();
+    ImGui::Text("Include:");
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(-1);
+    ImGui::InputTextWithHint("##IncludeFilter", "all", include_filter_, sizeof(include_filter_));
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("If set, only files matching one of these globs, separated by ';'\n"
+                          "Example: BP_*;Weapons/**");
+
     // Action buttons row
     ImGui::Spacing();
     ImGui::Separator();
@@ -184,7 +399,9 @@ void SearchAssetsGUI::render_search_panel()
 
     // Buttons with proper spacing
     ImVec2 button_size(80, 32);
-    if (!is_searching_)
+    // Durante una ricerca in background si può lanciarne una nuova, che la sostituisce
+    const bool searching = is_searching_;
+    if (!searching || searching_background_)
     {
         // Green search button
         ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.0f, 0.7f, 0.0f, 1.0f));
@@ -195,15 +412,16 @@ void SearchAssetsGUI::render_search_panel()
         }
         ImGui::PopStyleColor(2);
     }
-    else
+    if (searching)
     {
+        if (searching_background_)
+            ImGui::SameLine();
         // Red stop button
         ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.8f, 0.2f, 0.2f, 1.0f));
         ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4(0.9f, 0.3f, 0.3f, 1.0f));
         if (ImGui::Button("Stop Search") || ImGui::IsKeyPressed(ImGuiKey_Escape))
         {
-            if (search_engine_)
-                search_engine_->stop_search();
+            stop_current_search();
         }
         ImGui::PopStyleColor(2);
     }
@@ -237,8 +455,7 @@ void SearchAssetsGUI::render_search_panel()
     if (is_searching_)
     {
         ImGui::Spacing();
-        auto progress = progress_current_.load();
-        auto total = progress_total_.load();
+        const SearchProgress::Snapshot progress = search_engine_->get_progress();
 
         // Progress bar
         ImGui::Text("Progress:");
@@ -249,25 +466,35 @@ void SearchAssetsGUI::render_search_panel()
         if (available_width > 400)
             available_width = 400; // Max width cap
 
-        if (total > 0)
+        if (!waiting_for_daemon_ && search_engine_->is_searching() && progress.files_total > 0)
         {
-            float ratio = static_cast<float>(progress) / total;
+            // Sui byte: pochi file grossi pesano più di tanti piccoli
+            float ratio = progress.bytes_total > 0
+                              ? static_cast<float>(progress.bytes_done) / progress.bytes_total
+                              : static_cast<float>(progress.files_done) / progress.files_total;
             ImGui::PushStyleColor(ImGuiCol_PlotHistogram, ImVec4(0.0f, 0.8f, 0.2f, 1.0f));
             ImGui::ProgressBar(ratio, ImVec2(available_width, 24),
-                               (std::to_string(progress) + "/" + std::to_string(total) + " files (" + std::to_string((int)(ratio * 100)) + "%)").c_str());
+                               (std::to_string(progress.files_done) + "/" + std::to_string(progress.files_total) +
+                                " files (" + std::to_string((int)(ratio * 100)) + "%)").c_str());
             ImGui::PopStyleColor();
+            ImGui::Text("%s", progress_label(progress).c_str());
         }
         else
         {
             ImGui::PushStyleColor(ImGuiCol_PlotHistogram, ImVec4(0.28f, 0.56f, 1.00f, 1.0f));
-            ImGui::ProgressBar(-1.0f, ImVec2(available_width, 24), "Initializing search...");
+            ImGui::ProgressBar(-1.0f, ImVec2(available_width, 24),
+                               waiting_for_daemon_ ? "Waiting for daemon..." : "Initializing search...");
             ImGui::PopStyleColor();
         }
 
         // Current directory with truncation
-        if (!progress_message_.empty())
+        std::string current_msg;
+        {
+            std::lock_guard<std::mutex> lock(progress_mutex_);
+            current_msg = progress_message_;
+        }
+        if (!current_msg.empty())
         {
-            std::string current_msg = progress_message_;
             if (current_msg.length() > 60) // Truncate long paths
             {
                 current_msg = "..." + current_msg.substr(current_msg.length() - 57);
@@ -279,8 +506,14 @@ void SearchAssetsGUI::render_search_panel()
 
 void SearchAssetsGUI::render_results_panel()
 {
+    {
+        // Risultati arrivati dall'ultimo frame: fusi nella vista ordinata
+        std::lock_guard<std::mutex> lock(results_mutex_);
+        filtered_result_lines_.merge_pending(result_table_);
+    }
+
     // Results header with modern styling
-    auto total_results = result_lines_.size();
+    auto total_results = result_table_.size();
     auto filtered_results = filtered_result_lines_.size();
 
     ImGui::TextColored(ImVec4(0.28f, 0.56f, 1.00f, 1.00f), "Search Results");
@@ -306,6 +539,26 @@ void SearchAssetsGUI::render_results_panel()
     {
         ImGui::SameLine();
         ImGui::TextColored(ImVec4(0.5f, 0.7f, 1.0f, 1.0f), "  (%lld ms)", last_search_ms_.load());
+        if (ImGui::IsItemHovered())
+        {
+            SearchStats stats;
+            {
+                std::lock_guard<std::mutex> lock(results_mutex_);
+                stats = last_search_remote_ ? daemon_stats_ : search_engine_->get_stats();
+            }
+            if (search_engine_->get_content_cache_budget() > 0)
+            {
+                ImGui::SetTooltip("%zu files scanned\n%zu identical copies reused a previous result\n"
+                                  "Cache: %zu hits, %zu misses, %.1f MB used",
+                                  stats.files_scanned, stats.files_deduplicated,
+                                  stats.cache_hits, stats.cache_misses, stats.cache_bytes / (1024.0 * 1024.0));
+            }
+            else
+            {
+                ImGui::SetTooltip("%zu files scanned\n%zu identical copies reused a previous result",
+                                  stats.files_scanned, stats.files_deduplicated);
+            }
+        }
     }
 
     // Show status message to the right (copy all success or search warning)
@@ -352,6 +605,16 @@ void SearchAssetsGUI::render_results_panel()
     {
         update_filtered_results();
     }
+    ImGui::SameLine();
+    if (ImGui::Checkbox("Fuzzy", &fuzzy_filter_))
+    {
+        update_filtered_results();
+    }
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Letters in order, not necessarily adjacent (bpenmboss finds BP_Enemy_Boss).\n"
+                          "Best matches first; click a column header to sort by it instead.");
+    }
 
     // Copy buttons with dynamic positioning
     ImGui::SameLine();
@@ -373,7 +636,7 @@ void SearchAssetsGUI::render_results_panel()
     ImGui::Spacing();
 
     // Modern results table with enhanced styling
-    if (ImGui::BeginTable("ResultsTable", 1,
+    if (ImGui::BeginTable("ResultsTable", 6,
                           ImGuiTableFlags_Borders |
                               ImGuiTableFlags_RowBg |
                               ImGuiTableFlags_ScrollY |
@@ -381,261 +644,448 @@ void SearchAssetsGUI::render_results_panel()
                               ImGuiTableFlags_Resizable))
     {
         // Table headers
-        ImGui::TableSetupColumn("Asset Name", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupScrollFreeze(0, 1);
+        // User id = ResultColumn; i numeri partono dal più grande
+        const ImGuiTableColumnFlags numeric = ImGuiTableColumnFlags_WidthFixed | ImGuiTableColumnFlags_PreferSortDescending;
+        ImGui::TableSetupColumn("Asset Name", ImGuiTableColumnFlags_WidthStretch, 0.0f, static_cast<ImGuiID>(ResultColumn::Name));
+        ImGui::TableSetupColumn("Root", ImGuiTableColumnFlags_WidthFixed, 110.0f, static_cast<ImGuiID>(ResultColumn::Root));
+        ImGui::TableSetupColumn("Size", numeric, 70.0f, static_cast<ImGuiID>(ResultColumn::Size));
+        ImGui::TableSetupColumn("Modified", numeric, 110.0f, static_cast<ImGuiID>(ResultColumn::Modified));
+        ImGui::TableSetupColumn("Matches", numeric, 55.0f, static_cast<ImGuiID>(ResultColumn::Matches));
+        ImGui::TableSetupColumn("Score", numeric | ImGuiTableColumnFlags_DefaultSort, 45.0f, static_cast<ImGuiID>(ResultColumn::Score));
         ImGui::TableHeadersRow();
 
         std::lock_guard<std::mutex> lock(results_mutex_);
 
-        // Enhanced table rows with better visual feedback
-        for (size_t i = 0; i < filtered_result_lines_.size(); i++)
+        // Click su un'intestazione: si riordina solo quando le specifiche cambiano
+        if (ImGuiTableSortSpecs *sort_specs = ImGui::TableGetSortSpecs())
         {
-            ImGui::TableNextRow();
-            const auto &result = filtered_result_lines_[i];
-            bool is_selected = (static_cast<int>(i) == selected_result_);
-
-            // First column - Asset name
-            ImGui::TableNextColumn();
-
-            // Highlight selected row
-            if (is_selected)
+            if (sort_specs->SpecsDirty && sort_specs->SpecsCount > 0)
             {
-                ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0, ImGui::ColorConvertFloat4ToU32(ImVec4(0.28f, 0.56f, 1.00f, 0.3f)));
+                const ImGuiTableColumnSortSpecs &spec = sort_specs->Specs[0];
+                header_order_.column = static_cast<ResultColumn>(spec.ColumnUserID);
+                header_order_.descending = spec.SortDirection == ImGuiSortDirection_Descending;
+                filtered_result_lines_.set_order(result_table_, header_order_);
+                selected_result_ = 0;
             }
+            sort_specs->SpecsDirty = false;
+        }
 
-            if (ImGui::Selectable(("##row" + std::to_string(i)).c_str(), is_selected, ImGuiSelectableFlags_SpanAllColumns))
+        // Solo le righe visibili: con decine di migliaia di risultati il
+        // frame costa quanto una pagina
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(filtered_result_lines_.size()));
+        while (clipper.Step())
+        {
+            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
             {
-                selected_result_ = static_cast<int>(i);
-            }
+                ImGui::TableNextRow();
+                const ResultTable::Row row = filtered_result_lines_[i];
+                const std::string_view name = result_table_.name(row);
+                const std::string_view stem = name.substr(0, name.find_last_of('.'));
+                bool is_selected = (i == selected_result_);
 
-            // Double-click to copy with visual feedback
-            if (ImGui::IsItemHovered())
-            {
-                if (ImGui::IsMouseDoubleClicked(0))
+                // First column - Asset name
+                ImGui::TableNextColumn();
+
+                // Highlight selected row
+                if (is_selected)
+                {
+                    ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0, ImGui::ColorConvertFloat4ToU32(ImVec4(0.28f, 0.56f, 1.00f, 0.3f)));
+                }
+
+                if (ImGui::Selectable(("##row" + std::to_string(i)).c_str(), is_selected, ImGuiSelectableFlags_SpanAllColumns))
+                {
+                    selected_result_ = i;
+                }
+
+                // Double-click to copy with visual feedback
+                if (ImGui::IsItemHovered())
                 {
-                    selected_result_ = static_cast<int>(i);
-                    copy_selected_result();
+                    if (ImGui::IsMouseDoubleClicked(0))
+                    {
+                        selected_result_ = i;
+                        copy_selected_result();
+                    }
+
+                    // Show different tooltip based on copy status
+                    if (!last_single_copied_item_.empty() && last_single_copied_item_ == stem)
+                    {
+                        // Show success tooltip if this item was just copied
+                        ImGui::BeginTooltip();
+                        ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "Copied to clipboard!");
+                        ImGui::Text("Asset: %s", name.data());
+                        ImGui::EndTooltip();
+                    }
+                    else
+                    {
+                        // Show default tooltip
+                        const uint32_t edits = result_table_.edit_distance(row);
+                        ImGui::SetTooltip("Double-click to copy to clipboard\nAsset: %s\nRoot: %s%s%u%s",
+                                          name.data(), result_table_.root_path(result_table_.root(row)).c_str(),
+                                          edits > 0 ? "\nClosest match: " : "", edits,
+                                          edits > 0 ? (edits == 1 ? " typo" : " typos") : "");
+                    }
                 }
 
-                // Show different tooltip based on copy status
-                if (!last_single_copied_item_.empty() && last_single_copied_item_ == result.substr(0, result.find_last_of('.')))
+                // Show the filename
+                ImGui::SameLine(0, 0);
+                ImGui::TextUnformatted(name.data(), name.data() + name.size());
+
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(result_table_.root_label(result_table_.root(row)).c_str());
+
+                // Size e data: non note per i risultati della ricerca sui soli nomi
+                char cell[32];
+                const bool metadata_known = result_table_.mtime(row) != 0;
+                ImGui::TableNextColumn();
+                if (metadata_known)
                 {
-                    // Show success tooltip if this item was just copied
-                    ImGui::BeginTooltip();
-                    ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "Copied to clipboard!");
-                    ImGui::Text("Asset: %s", result.c_str());
-                    ImGui::EndTooltip();
+                    format_size(result_table_.file_size(row), cell, sizeof(cell));
+                    ImGui::TextUnformatted(cell);
                 }
-                else
+                ImGui::TableNextColumn();
+                if (metadata_known)
                 {
-                    // Show default tooltip
-                    ImGui::SetTooltip("Double-click to copy to clipboard\nAsset: %s", result.c_str());
+                    format_mtime(result_table_.mtime(row), cell, sizeof(cell));
+                    ImGui::TextUnformatted(cell);
                 }
-            }
 
-            // Show the filename
-            ImGui::SameLine(0, 0);
-            ImGui::Text("%s", result.c_str());
+                ImGui::TableNextColumn();
+                const uint32_t matches = result_table_.match_count(row);
+                if (matches > 0)
+                {
+                    // "~1": le occorrenze migliori hanno un errore
+                    const uint32_t edits = result_table_.edit_distance(row);
+                    if (edits > 0)
+                        ImGui::Text("%u%s ~%u", matches, matches >= SearchEngine::kMaxCountedMatches ? "+" : "", edits);
+                    else
+                        ImGui::Text("%u%s", matches, matches >= SearchEngine::kMaxCountedMatches ? "+" : "");
+                }
+
+                ImGui::TableNextColumn();
+                ImGui::Text("%d", result_table_.score(row));
+            }
         }
 
         ImGui::EndTable();
     }
 }
 
-void SearchAssetsGUI::perform_search()
+void SearchAssetsGUI::stop_current_search()
 {
-    if (is_searching_ || strlen(search_pattern_) == 0)
+    cancel_requested_ = true;
+    if (search_engine_)
     {
-        return;
+        search_engine_->stop_search();
     }
+    // Ricerca sul daemon: la risposta non serve più
+    daemon_client_.interrupt();
+}
 
-    // Update file size limits from UI
-    try
+void SearchAssetsGUI::perform_search()
+{
+    if ((is_searching_ && !searching_background_) || strlen(search_pattern_) == 0)
     {
-        double min_kb = std::stod(min_file_size_str_);
-        double max_kb = std::stod(max_file_size_str_);
-        size_t min_bytes = static_cast<size_t>(min_kb * 1024);
-        size_t max_bytes = static_cast<size_t>(max_kb * 1024);
-        search_engine_->set_file_size_limits(min_bytes, max_bytes);
+        return;
     }
-    catch (const std::exception &)
+
+    // Una ricerca in background in corso lascia il posto a quella nuova:
+    // la tabella dei risultati è una sola
+    if (is_searching_)
     {
-        // Use default values if parsing fails
+        stop_current_search();
     }
-
-    // Sanitize search pattern if Unreal prefix removal is enabled
-    std::string actual_search_pattern = search_pattern_;
-    if (remove_unreal_prefixes_)
+    if (search_thread_.joinable())
     {
-        actual_search_pattern = remove_unreal_prefix(search_pattern_);
+        search_thread_.join();
     }
 
-    // NON aggiungere \b qui, passa il flag invece al search engine
-    search_engine_->set_match_whole_word(match_whole_word_);
+    SearchRequest request = build_request();
 
     reset_search();
+    cancel_requested_ = false;
     is_searching_ = true;
-
-    std::vector<std::filesystem::path> search_paths;
-
-    // Determine search paths
-    if (strlen(custom_path_) > 0)
+    searching_background_ = request.background;
     {
-        search_paths.push_back(std::filesystem::path(custom_path_));
+        std::lock_guard<std::mutex> lock(results_mutex_);
+        result_table_.set_roots(request.paths); // SearchResult::root indicizza queste
     }
-    else
+
+    if (request.paths.empty())
     {
-        // Default Content/Assets path
-        if (std::filesystem::exists("Content/Assets"))
-        {
-            search_paths.push_back(std::filesystem::path("Content/Assets"));
-        }
+        is_searching_ = false;
+        searching_background_ = false;
+        update_progress("No search paths available");
+        return;
+    }
 
-        // Add plugin paths if enabled
-        if (search_plugins_)
+    // Start search in separate thread
+    search_thread_ = std::thread([this, request]()
+                              {
+        auto t0 = std::chrono::steady_clock::now();
+        bool remote = false;
+        SearchStats remote_stats;
+        if (use_daemon_)
         {
-            try
+            // Connessione persistente: la riapre solo se il daemon l'ha chiusa
+            if (!daemon_client_.connected())
             {
-                if (std::filesystem::exists("Plugins"))
+                daemon_client_.connect();
+            }
+            SearchClient::Reply reply;
+            waiting_for_daemon_ = true;
+            // Controllato dopo connect: uno stop successivo trova il socket
+            // aperto e interrompe la search
+            const bool answered = !cancel_requested_ && daemon_client_.connected() && daemon_client_.search(request, reply);
+            waiting_for_daemon_ = false;
+            if (answered)
+            {
+                remote = true;
+                for (const auto& message : reply.messages)
                 {
-                    for (const auto &plugin_dir : std::filesystem::directory_iterator("Plugins"))
-                    {
-                        if (plugin_dir.is_directory())
-                        {
-                            auto content_path = plugin_dir.path() / "Content";
-                            if (std::filesystem::exists(content_path))
-                            {
-                                search_paths.push_back(content_path);
-                            }
-                        }
-                    }
+                    update_progress(message);
+                }
+                for (const auto& result : reply.results)
+                {
+                    add_result(result);
                 }
+                remote_stats = reply.stats;
             }
-            catch (const std::filesystem::filesystem_error &)
+            else if (!cancel_requested_)
             {
-                // Skip if can't access Plugins directory
+                update_progress("Daemon not reachable, searching locally");
             }
         }
+        // Fermata prima di partire (o mentre aspettava il daemon): niente
+        // ricerca locale al suo posto
+        if (!remote && !cancel_requested_)
+        {
+            search_engine_->search(
+                request,
+                [this](const std::string& message, size_t, size_t) {
+                    update_progress(message);
+                },
+                [this](const SearchResult& result) {
+                    add_result(result);
+                }
+            );
+        }
+        {
+            // Letti dalla UI a ogni frame
+            std::lock_guard<std::mutex> lock(results_mutex_);
+            last_search_remote_ = remote;
+            daemon_stats_ = remote_stats;
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        last_search_ms_ = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+        searching_background_ = false;
+        is_searching_ = false; });
+}
+
+SearchRequest SearchAssetsGUI::build_request() const
+{
+    SearchRequest request;
+    request.pattern = effective_pattern();
+    request.paths = build_search_paths();
+    request.include = include_filter_;
+    request.exclude = exclude_filter_;
+    request.extensions = extension_filter_;
+    // NON aggiungere \b al pattern, passa il flag invece al search engine
+    request.whole_word = match_whole_word_;
+    request.case_sensitive = match_case_;
+    request.max_edits = static_cast<size_t>(max_edits_choice_);
+    request.names_only = names_only_;
+    request.search_paks = search_paks_;
+    static const size_t kLimits[] = {0, 1, 50, 500};
+    request.max_results = kLimits[result_limit_choice_];
+    request.prioritize_likely = prioritize_likely_;
+    request.physical_order = disk_order_;
+    request.adaptive_threads = adaptive_threads_;
+    request.background = background_;
+    request.prefetch_depth = disk_order_ ? 16 : 0; // su HDD il prefetch tiene la coda del disco piena
+
+    // Update file size limits from UI
+    try
+    {
+        double min_kb = std::stod(min_file_size_str_);
+        double max_kb = std::stod(max_file_size_str_);
+        request.min_file_size = static_cast<uint64_t>(min_kb * 1024);
+        request.max_file_size = static_cast<uint64_t>(max_kb * 1024);
+    }
+    catch (const std::exception &)
+    {
+        // Use default values if parsing fails
+    }
+    return request;
+}
+
+std::string SearchAssetsGUI::effective_pattern() const
+{
+    // Sanitize search pattern if Unreal prefix removal is enabled
+    if (remove_unreal_prefixes_)
+    {
+        // Query: ogni termine per conto suo
+        if (BooleanQuery::looks_like_query(search_pattern_))
+        {
+            return BooleanQuery::map_terms(search_pattern_, [this](std::string_view term) {
+                return remove_unreal_prefix(std::string(term));
+            });
+        }
+        return remove_unreal_prefix(search_pattern_);
     }
+    return search_pattern_;
+}
 
-    if (search_paths.empty())
+std::vector<std::filesystem::path> SearchAssetsGUI::build_search_paths() const
+{
+    // Determine search paths
+    if (strlen(custom_path_) > 0)
+    {
+        return {std::filesystem::path(custom_path_)};
+    }
+    return SearchEngine::default_search_paths(search_plugins_);
+}
+
+void SearchAssetsGUI::apply_file_filter()
+{
+    search_engine_->set_file_filter(FileFilter::compile(include_filter_, exclude_filter_, extension_filter_));
+}
+
+void SearchAssetsGUI::update_name_typeahead()
+{
+    if (is_searching_)
     {
-        is_searching_ = false;
-        update_progress("No search paths available", 0, 0);
         return;
     }
 
-    // Start search in separate thread
-    std::thread search_thread([this, search_paths, actual_search_pattern]()
-                              {
-        auto t0 = std::chrono::steady_clock::now();
-        search_engine_->search(
-            actual_search_pattern,
-            search_paths,
-            [this](const std::string& message, size_t current, size_t total) {
-                update_progress(message, current, total);
-            },
-            [this](const SearchResult& result) {
-                add_result(result);
-            }
-        );
-        auto t1 = std::chrono::steady_clock::now();
-        last_search_ms_ = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
-        is_searching_ = false; });
-    search_thread.detach();
+    apply_file_filter();
+
+    std::vector<SearchResult> hits;
+    if (strlen(search_pattern_) > 0 &&
+        !search_engine_->query_names(effective_pattern(), build_search_paths(), kTypeAheadLimit, hits))
+    {
+        return; // indice non ancora costruito: Enter avvia la ricerca che lo crea
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(results_mutex_);
+        result_table_.clear();
+        result_table_.set_roots(build_search_paths());
+        filtered_result_lines_.clear();
+        selected_result_ = 0;
+    }
+    for (const auto &hit : hits)
+    {
+        add_result(hit);
+    }
 }
 
 void SearchAssetsGUI::reset_search()
 {
+    stop_current_search();
     if (search_engine_)
     {
-        search_engine_->stop_search();
         search_engine_->clear_results();
     }
 
     {
         std::lock_guard<std::mutex> lock(results_mutex_);
-        result_lines_.clear();
+        result_table_.clear();
         filtered_result_lines_.clear();
-        seen_filenames_.clear();
         selected_result_ = 0;
     }
 
     memset(result_filter_, 0, sizeof(result_filter_));
     last_copied_item_.clear();
 
-    progress_message_ = "";
-    progress_current_ = 0;
-    progress_total_ = 0;
+    update_progress("");
     last_search_ms_ = -1;
     is_searching_ = false;
 }
 
-void SearchAssetsGUI::update_progress(const std::string &message, size_t current, size_t total)
+void SearchAssetsGUI::update_progress(const std::string &message)
 {
+    // Chiamata dai thread della ricerca, letta dal thread della UI
+    std::lock_guard<std::mutex> lock(progress_mutex_);
     progress_message_ = message;
-    progress_current_ = current;
-    progress_total_ = total;
+}
+
+std::string SearchAssetsGUI::progress_label(const SearchProgress::Snapshot &progress) const
+{
+    char label[128];
+    const double mb_per_second = progress.bytes_per_second / (1024.0 * 1024.0);
+    if (progress.eta_seconds < 0.0)
+    {
+        snprintf(label, sizeof(label), "%.0f files/s  %.1f MB/s", progress.files_per_second, mb_per_second);
+    }
+    else if (progress.eta_seconds < 60.0)
+    {
+        snprintf(label, sizeof(label), "%.0f files/s  %.1f MB/s  ETA %.0fs",
+                 progress.files_per_second, mb_per_second, progress.eta_seconds);
+    }
+    else
+    {
+        const int eta = static_cast<int>(progress.eta_seconds);
+        snprintf(label, sizeof(label), "%.0f files/s  %.1f MB/s  ETA %dm %02ds",
+                 progress.files_per_second, mb_per_second, eta / 60, eta % 60);
+    }
+    return label;
 }
 
 void SearchAssetsGUI::add_result(const SearchResult &result)
 {
     std::lock_guard<std::mutex> lock(results_mutex_);
 
-    // Show only the filename (without path)
-    std::string filename = result.file_path.filename().string();
-
-    // Check if filename already exists in results to avoid duplicates (O(1))
-    if (seen_filenames_.insert(filename).second)
+    // Un nome già in tabella (stesso asset in un'altra cartella) non si ripete
+    if (!result_table_.add(result))
     {
-        result_lines_.push_back(filename);
-        // Update filtered results inline to avoid double locking.
-        // Append solo il nuovo elemento: copiare tutto il vettore ad ogni
-        // risultato renderebbe add_result O(N^2) sul totale dei match.
-        if (strlen(result_filter_) == 0)
-        {
-            filtered_result_lines_.push_back(filename);
-        }
-        else
-        {
-            // Re-filter all results
-            std::string filter = result_filter_;
-            std::transform(filter.begin(), filter.end(), filter.begin(), ::tolower);
-
-            std::string filename_lower = filename;
-            std::transform(filename_lower.begin(), filename_lower.end(), filename_lower.begin(), ::tolower);
+        return;
+    }
+    const auto row = static_cast<ResultTable::Row>(result_table_.size() - 1);
 
-            if (filename_lower.find(filter) != std::string::npos)
-            {
-                filtered_result_lines_.push_back(filename);
-            }
-        }
+    // Update filtered results inline to avoid double locking.
+    // Inserisce solo il nuovo elemento: rifiltrare tutto ad ogni
+    // risultato renderebbe add_result O(N^2) sul totale dei match.
+    bool visible = true;
+    if (result_filter_[0] != '\0')
+    {
+        visible = fuzzy_filter_ ? result_table_.fuzzy_match(row, fuzzy_pattern_)
+                                : result_table_.name_contains(row, to_lower_copy(result_filter_));
+    }
+    if (visible)
+    {
+        filtered_result_lines_.insert(row);
     }
 }
 
 void SearchAssetsGUI::update_filtered_results()
 {
     std::lock_guard<std::mutex> lock(results_mutex_);
-    filtered_result_lines_.clear();
 
-    std::string filter = result_filter_;
-    if (filter.empty())
+    fuzzy_pattern_ = FuzzyPattern(result_filter_);
+    if (fuzzy_filter_ && !fuzzy_pattern_.empty())
     {
-        filtered_result_lines_ = result_lines_;
+        // Migliori corrispondenze in cima finché non si sceglie una colonna
+        ResultOrder by_match;
+        by_match.column = ResultColumn::Fuzzy;
+        by_match.descending = true;
+        filtered_result_lines_.assign(result_table_, result_table_.fuzzy_filter(fuzzy_pattern_), by_match);
     }
     else
     {
-        std::transform(filter.begin(), filter.end(), filter.begin(), ::tolower);
-
-        for (const auto &result : result_lines_)
+        // Solo la colonna dei nomi, poi un ordinamento della vista
+        const std::string filter = to_lower_copy(result_filter_);
+        std::vector<ResultTable::Row> rows;
+        rows.reserve(result_table_.size());
+        for (ResultTable::Row row = 0; row < result_table_.size(); ++row)
         {
-            std::string result_lower = result;
-            std::transform(result_lower.begin(), result_lower.end(), result_lower.begin(), ::tolower);
-
-            if (result_lower.find(filter) != std::string::npos)
+            if (filter.empty() || result_table_.name_contains(row, filter))
             {
-                filtered_result_lines_.push_back(result);
+                rows.push_back(row);
             }
         }
+        filtered_result_lines_.assign(result_table_, std::move(rows), header_order_);
     }
 
     if (selected_result_ >= static_cast<int>(filtered_result_lines_.size()))
@@ -644,7 +1094,7 @@ void SearchAssetsGUI::update_filtered_results()
     }
 }
 
-std::string SearchAssetsGUI::remove_unreal_prefix(const std::string &filename)
+std::string SearchAssetsGUI::remove_unreal_prefix(const std::string &filename) const
 {
     if (filename.length() < 2)
         return filename;
@@ -692,7 +1142,7 @@ void SearchAssetsGUI::copy_selected_result()
             return;
         }
 
-        std::string selected_item = filtered_result_lines_[selected_result_];
+        std::string selected_item(result_table_.name(filtered_result_lines_[selected_result_]));
 
         // Remove file extension
         size_t dot_pos = selected_item.find_last_of('.');
@@ -725,6 +1175,7 @@ void SearchAssetsGUI::copy_all_results()
     }
 
     std::lock_guard<std::mutex> lock(results_mutex_);
+    filtered_result_lines_.merge_pending(result_table_);
 
     if (filtered_result_lines_.empty())
     {
@@ -732,14 +1183,27 @@ void SearchAssetsGUI::copy_all_results()
         return;
     }
 
-    // Create a formatted string with all results
+    // Una riga per risultato, colonne separate da tab (si incolla in un foglio di calcolo)
     std::stringstream ss;
-    ss << "Search Results (" << filtered_result_lines_.size() << " items):\n";
-    ss << "====================================\n";
+    ss << "Name\tRoot\tSize\tModified\tMatches\tScore\tTypos\n";
 
+    char size_cell[32];
+    char mtime_cell[32];
     for (size_t i = 0; i < filtered_result_lines_.size(); ++i)
     {
-        ss << (i + 1) << ". " << filtered_result_lines_[i] << "\n";
+        const ResultTable::Row row = filtered_result_lines_[i];
+        size_cell[0] = mtime_cell[0] = '\0';
+        if (result_table_.mtime(row) != 0)
+        {
+            format_size(result_table_.file_size(row), size_cell, sizeof(size_cell));
+            format_mtime(result_table_.mtime(row), mtime_cell, sizeof(mtime_cell));
+        }
+        ss << result_table_.name(row) << '\t'
+           << result_table_.root_path(result_table_.root(row)) << '\t'
+           << size_cell << '\t' << mtime_cell << '\t'
+           << result_table_.match_count(row) << '\t'
+           << result_table_.score(row) << '\t'
+           << result_table_.edit_distance(row) << '\n';
     }
 
     std::string all_results = ss.str();
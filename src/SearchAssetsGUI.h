@@ -1,5 +1,7 @@
 #pragma once
 
+#include "ResultTable.h"
+#include "SearchDaemon.h"
 #include "SearchEngine.h"
 #include "ControllerEmulator.h"
 #include "ControllerPanel.h"
@@ -10,7 +12,7 @@
 #include <vector>
 #include <atomic>
 #include <mutex>
-#include <unordered_set>
+#include <thread>
 
 // Forward declaration — evita di includere GLFW nell'header
 struct GLFWwindow;
@@ -28,17 +30,26 @@ private:
     void render_results_panel();
     void render_controller_tab();
     void resize_to_tab(int tab);   // ridimensiona e ricentra la finestra
-    void update_progress(const std::string &message, size_t current, size_t total);
+    void update_progress(const std::string &message);
+    std::string progress_label(const SearchProgress::Snapshot &progress) const;
     void add_result(const SearchResult &result);
     void perform_search();
+    void stop_current_search(); // non aspetta il thread di ricerca
+    void update_name_typeahead();
+    std::vector<std::filesystem::path> build_search_paths() const;
+    SearchRequest build_request() const;
+    std::string effective_pattern() const;
+    void apply_file_filter();
     void reset_search();
     void update_filtered_results();
     void copy_selected_result();
     void copy_all_results();
-    std::string remove_unreal_prefix(const std::string& filename);
+    std::string remove_unreal_prefix(const std::string& filename) const;
     void set_clipboard(const std::string& text);
     std::string get_clipboard();
 
+    static constexpr size_t kTypeAheadLimit = 5000; // righe max per il type-ahead sui nomi
+
     // UI State
     char search_pattern_[256] = "";
     char custom_path_[512] = "";
@@ -46,23 +57,45 @@ private:
     bool search_plugins_ = false;
     bool remove_unreal_prefixes_ = true;
     bool match_whole_word_ = false;
+    bool match_case_ = false;
+    bool names_only_ = false;      // cerca solo nei nomi dei file (indice in memoria)
+    bool search_paks_ = false;     // apre anche gli archivi .pak
+    bool use_daemon_ = false;      // manda le ricerche a un daemon già avviato
+    bool disk_order_ = false;      // HDD/rete: lettura in ordine fisico
+    bool adaptive_threads_ = false; // worker regolati sul throughput
+    bool background_ = false;       // priorità minime, in pausa durante le ricerche in primo piano
+    bool fuzzy_filter_ = false;     // filtro risultati come sottosequenza, migliori in cima
+
+    // Regole del walk (vedi FileFilter)
+    char extension_filter_[128] = "";  // FileFilter::kDefaultExtensions
+    char exclude_filter_[256] = "";    // FileFilter::kDefaultExclude
+    char include_filter_[256] = "";
 
     // File size limits (in KB for easier UI)
     char min_file_size_str_[16] = "0.1"; // 100 bytes = 0.1 KB
     char max_file_size_str_[16] = "2000";
+    int content_cache_choice_ = 0; // indice nel combo della ContentCache (0 = off)
+    int result_limit_choice_ = 0;  // indice nel combo "Stop after" (0 = tutti)
+    int max_edits_choice_ = 0;     // errori ammessi nel contenuto (0 = ricerca esatta)
+    bool prioritize_likely_ = true;
 
     // Search state
     std::atomic<bool> is_searching_{false};
+    std::atomic<bool> searching_background_{false}; // la ricerca in corso è in background
+    std::atomic<bool> cancel_requested_{false};     // niente fallback locale se il daemon è stato interrotto
+    std::thread search_thread_;
+    // Solo i messaggi di stato: i contatori li dà SearchEngine::get_progress()
+    mutable std::mutex progress_mutex_;
     std::string progress_message_;
-    std::atomic<size_t> progress_current_{0};
-    std::atomic<size_t> progress_total_{0};
+    std::atomic<bool> waiting_for_daemon_{false}; // nessun progresso locale da mostrare
     std::atomic<long long> last_search_ms_{-1}; // durata ultima ricerca (-1 = nessuna)
 
     // Results
     mutable std::mutex results_mutex_;
-    std::vector<std::string> result_lines_;
-    std::vector<std::string> filtered_result_lines_;
-    std::unordered_set<std::string> seen_filenames_; // dedup O(1) durante la ricerca
+    ResultTable result_table_;            // colonne, in ordine di arrivo
+    SortedResults filtered_result_lines_; // righe che passano il filtro, nell'ordine scelto
+    ResultOrder header_order_;            // ultimo ordine scelto dalle intestazioni
+    FuzzyPattern fuzzy_pattern_{""};      // del filtro corrente, per i risultati in arrivo
     int selected_result_ = 0;
     std::string last_copied_item_;
     std::string last_single_copied_item_; // For tooltip feedback
@@ -70,6 +103,13 @@ private:
     // Search engine
     std::unique_ptr<SearchEngine> search_engine_;
 
+    // Daemon: il client lo usa il thread di ricerca (la UI solo per
+    // interrupt); esito e statistiche dell'ultima ricerca li pubblica
+    // sotto results_mutex_
+    SearchClient daemon_client_;
+    SearchStats daemon_stats_;
+    bool last_search_remote_ = false;
+
     // Xbox Controller
     std::unique_ptr<ControllerEmulator>              controller_emulator_;
     std::array<std::unique_ptr<ControllerPanel>, 4>  controller_panels_;
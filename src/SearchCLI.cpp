@@ -0,0 +1,230 @@
+#include "SearchCLI.h"
+#include "SearchDaemon.h"
+#include "SearchEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static void print_usage()
+{
+    std::cerr <<
+        "Usage: SearchAssetsV2 --search <pattern> [options]\n"
+        "       <pattern> is text, a regex, or a query: \"Damage AND Shield AND NOT Deprecated\"\n"
+        "       (AND/OR/NOT, parentheses, word:<term>, re:<regex>, lit:<text>)\n"
+        "       SearchAssetsV2 --daemon [--socket <path>] [--cache-mb <n>]\n"
+        "\n"
+        "  --path <dir>        Search root (repeatable). Default: Content/Assets\n"
+        "  --plugins           Also search Plugins/*/Content (default roots only)\n"
+        "  --whole-word        Match whole words only\n"
+        "  --case-sensitive    Distinguish upper and lower case in file contents\n"
+        "  --max-edits <n>     Also match the pattern with up to n typos (1-3, literal patterns)\n"
+        "  --names-only        Match file names only, do not open files\n"
+        "  --ext <list>        Extension allow-list, ';' separated (default: " << FileFilter::kDefaultExtensions << ")\n"
+        "  --exclude <list>    Folders/files to skip, ';' separated (default: " << FileFilter::kDefaultExclude << ")\n"
+        "  --include <list>    Only files matching one of these globs\n"
+        "  --paks              Also search inside .pak archives (cooked builds)\n"
+        "  --max-results <n>   Stop the whole search after n results (exit code 0 = found)\n"
+        "  --traversal-order   Scan files in walk order instead of most likely matches first\n"
+        "  --disk-order        HDD/network: read files in on-disk order, few readers per device\n"
+        "  --device-threads <n> Readers per device with --disk-order (default 2)\n"
+        "  --prefetch <n>      Ask the OS to read the next n files ahead; scanned files leave the page cache\n"
+        "  --all-files         Clear the default --ext and --exclude rules\n"
+        "  --min-kb <n>        Skip files smaller than n KB (default 0.1)\n"
+        "  --max-kb <n>        Skip files larger than n KB (default 2000)\n"
+        "  --threads <n>       Worker threads (default: hardware threads)\n"
+        "  --adaptive          Tune active threads to measured throughput (--threads = maximum)\n"
+        "  --background        Lowest CPU/I/O priority; pause while the system or a foreground search is busy\n"
+        "  --max-mbps <n>      With --background: read at most n MB/s\n"
+        "  --no-snapshot       Always walk the tree, do not read/write the file list snapshot\n"
+        "  --stream            Print results as they are found instead of sorted by relevance\n"
+        "  --daemon            Stay resident and serve searches from other instances\n"
+        "  --use-daemon        Send the search to a running daemon (falls back to a local search)\n"
+        "  --socket <path>     Daemon socket (default: " << SearchDaemon::default_socket_path().string() << ")\n"
+        "  --cache-mb <n>      In-memory content cache size (default: 0, daemon: 256)\n"
+        "  --help              Show this help\n";
+}
+
+static int run_daemon(const std::filesystem::path &socket_path, size_t threads, bool snapshot, int cache_mb)
+{
+    SearchDaemon daemon(socket_path);
+    for (SearchEngine *engine : {&daemon.engine(), &daemon.background_engine()})
+    {
+        if (threads > 0)
+            engine->set_thread_count(threads);
+        if (snapshot)
+            engine->set_snapshot_dir(SearchEngine::default_snapshot_dir());
+    }
+    // La cache dei contenuti serve alle ricerche interattive
+    daemon.engine().set_content_cache_budget(static_cast<size_t>(cache_mb < 0 ? 256 : cache_mb) * 1024 * 1024);
+
+    std::string error;
+    if (!daemon.start(error))
+    {
+        std::cerr << "Error: " << error << "\n";
+        return 2;
+    }
+    std::cerr << "Listening on " << socket_path.string() << "\n";
+    daemon.run();
+    return 0;
+}
+
+int run_cli(int argc, char **argv)
+{
+    SearchRequest request;
+    request.min_file_size = static_cast<uint64_t>(0.1 * 1024); // default di --min-kb / --max-kb
+    request.max_file_size = 2000 * 1024;
+    bool plugins = false;
+    size_t threads = 0;
+    bool snapshot = true;
+    bool daemon = false;
+    bool use_daemon = false;
+    bool stream = false;
+    std::filesystem::path socket_path = SearchDaemon::default_socket_path();
+    int cache_mb = -1; // -1 = default della modalità
+
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc)
+                    throw std::invalid_argument("missing value for " + arg);
+                return argv[++i];
+            };
+
+            if (arg == "--search")          request.pattern = value();
+            else if (arg == "--path")       request.paths.emplace_back(value());
+            else if (arg == "--plugins")    plugins = true;
+            else if (arg == "--whole-word") request.whole_word = true;
+            else if (arg == "--case-sensitive") request.case_sensitive = true;
+            else if (arg == "--max-edits")  request.max_edits = std::stoul(value());
+            else if (arg == "--names-only") request.names_only = true;
+            else if (arg == "--paks")       request.search_paks = true;
+            else if (arg == "--max-results") request.max_results = std::stoul(value());
+            else if (arg == "--likely-first") request.prioritize_likely = true;
+            else if (arg == "--traversal-order") request.prioritize_likely = false;
+            else if (arg == "--disk-order") request.physical_order = true;
+            else if (arg == "--device-threads") request.device_threads = std::stoul(value());
+            else if (arg == "--prefetch")   request.prefetch_depth = std::stoul(value());
+            else if (arg == "--ext")        request.extensions = value();
+            else if (arg == "--exclude")    request.exclude = value();
+            else if (arg == "--include")    request.include = value();
+            else if (arg == "--all-files")  request.extensions.clear(), request.exclude.clear();
+            else if (arg == "--min-kb")     request.min_file_size = static_cast<uint64_t>(std::stod(value()) * 1024);
+            else if (arg == "--max-kb")     request.max_file_size = static_cast<uint64_t>(std::stod(value()) * 1024);
+            else if (arg == "--threads")    threads = std::stoul(value());
+            else if (arg == "--adaptive")   request.adaptive_threads = true;
+            else if (arg == "--background") request.background = true;
+            else if (arg == "--max-mbps")   request.background_bandwidth = static_cast<uint64_t>(std::stod(value()) * 1024 * 1024);
+            else if (arg == "--no-snapshot") snapshot = false;
+            else if (arg == "--stream")     stream = true;
+            else if (arg == "--daemon")     daemon = true;
+            else if (arg == "--use-daemon") use_daemon = true;
+            else if (arg == "--socket")     socket_path = value();
+            else if (arg == "--cache-mb")   cache_mb = std::stoi(value());
+            else if (arg == "--help" || arg == "-h")
+            {
+                print_usage();
+                return 0;
+            }
+            else
+                throw std::invalid_argument("unknown option " + arg);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n\n";
+        print_usage();
+        return 2;
+    }
+
+    if (daemon)
+    {
+        return run_daemon(socket_path, threads, snapshot, cache_mb);
+    }
+
+    if (request.pattern.empty())
+    {
+        print_usage();
+        return 2;
+    }
+    if (request.paths.empty())
+    {
+        request.paths = SearchEngine::default_search_paths(plugins);
+    }
+    if (request.paths.empty())
+    {
+        std::cerr << "No search paths available\n";
+        return 2;
+    }
+
+    // Si stampano solo i path: le occorrenze servono all'ordinamento per
+    // rilevanza, che con --stream non c'è
+    request.count_matches = !stream;
+
+    std::vector<SearchResult> results;
+    size_t streamed = 0; // --stream: già stampati, non in results
+    SearchStats stats;
+    auto t0 = std::chrono::steady_clock::now();
+
+    SearchClient client;
+    SearchClient::Reply reply;
+    if (use_daemon && client.connect(socket_path) && client.search(request, reply))
+    {
+        for (const auto &message : reply.messages)
+            std::cerr << message << "\n";
+        results = std::move(reply.results);
+        stats = reply.stats;
+    }
+    else
+    {
+        if (use_daemon)
+            std::cerr << "Daemon not reachable on " << socket_path.string() << ", searching locally\n";
+
+        SearchEngine engine;
+        if (threads > 0)
+            engine.set_thread_count(threads);
+        if (snapshot)
+            engine.set_snapshot_dir(SearchEngine::default_snapshot_dir());
+        if (cache_mb > 0)
+            engine.set_content_cache_budget(static_cast<size_t>(cache_mb) * 1024 * 1024);
+
+        auto print_message = [](const std::string &message, size_t, size_t total) {
+            if (total == 0) // messaggi di stato/errore, non l'avanzamento
+                std::cerr << message << "\n";
+        };
+        if (stream)
+        {
+            // Output man mano che arrivano: chi legge la pipe detta il ritmo
+            for (const auto &batch : engine.stream(request, 100, 1000, print_message))
+            {
+                for (const auto &result : batch)
+                    std::cout << result.file_path.string() << "\n";
+                std::cout.flush();
+                streamed += batch.size();
+            }
+        }
+        else
+        {
+            engine.search(request, print_message);
+            results = engine.get_results();
+        }
+        stats = engine.get_stats();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    std::stable_sort(results.begin(), results.end(),
+                     [](const SearchResult &a, const SearchResult &b) { return a.score > b.score; });
+    for (const auto &result : results)
+        std::cout << result.file_path.string() << "\n";
+
+    const size_t result_count = results.size() + streamed;
+    std::cerr << result_count << " results in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count() << " ms ("
+              << stats.files_scanned << " files scanned, "
+              << stats.files_deduplicated << " duplicates skipped)\n";
+    return result_count == 0 ? 1 : 0;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// Modalità riga di comando, senza finestra:
+//   SearchAssetsV2 --search <pattern> [--path <dir>]... [opzioni]
+// Stampa i path trovati (più rilevanti prima) su stdout e un riepilogo su
+// stderr. Ritorna l'exit code del processo.
+int run_cli(int argc, char **argv);
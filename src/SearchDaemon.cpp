@@ -0,0 +1,466 @@
+#include "SearchDaemon.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+// Frame: header fisso + payload. Stessa macchina, quindi byte order nativo.
+enum class Frame : uint32_t { Request = 1, Results = 2, Ack = 3, Error = 4, Ping = 5, Pong = 6 };
+
+struct FrameHeader
+{
+    uint32_t magic;
+    uint32_t type;
+    uint64_t length;
+};
+
+constexpr uint32_t kFrameMagic   = 0x31564153; // "SAV1"
+constexpr uint64_t kMaxFrameSize = 256ull * 1024 * 1024;
+constexpr size_t   kInlineLimit  = 64 * 1024;  // oltre: memoria condivisa
+
+enum class Transport : uint8_t { Inline = 0, Shared = 1 };
+
+bool send_frame(const LocalSocket& socket, Frame type, std::string_view payload)
+{
+    const FrameHeader header{kFrameMagic, static_cast<uint32_t>(type), payload.size()};
+    return socket.send_all(&header, sizeof(header)) &&
+           (payload.empty() || socket.send_all(payload.data(), payload.size()));
+}
+
+bool recv_frame(const LocalSocket& socket, Frame& type, std::string& payload)
+{
+    FrameHeader header{};
+    if (!socket.recv_all(&header, sizeof(header)) || header.magic != kFrameMagic ||
+        header.length > kMaxFrameSize) {
+        return false;
+    }
+    type = static_cast<Frame>(header.type);
+    payload.resize(static_cast<size_t>(header.length));
+    return payload.empty() || socket.recv_all(payload.data(), payload.size());
+}
+
+std::string path_to_utf8(const std::filesystem::path& path)
+{
+    const std::u8string utf8 = path.u8string();
+    return std::string(reinterpret_cast<const char*>(utf8.data()), utf8.size());
+}
+
+std::filesystem::path path_from_utf8(std::string_view utf8)
+{
+    return std::filesystem::path(std::u8string(reinterpret_cast<const char8_t*>(utf8.data()), utf8.size()));
+}
+
+class Writer
+{
+public:
+    template <typename T>
+    void put(T value)
+    {
+        const size_t at = out_.size();
+        out_.resize(at + sizeof(T));
+        std::memcpy(out_.data() + at, &value, sizeof(T));
+    }
+    void put_string(std::string_view s)
+    {
+        put<uint32_t>(static_cast<uint32_t>(s.size()));
+        out_.append(s);
+    }
+    void put_bytes(std::string_view s) { out_.append(s); }
+
+    std::string &str() { return out_; }
+
+private:
+    std::string out_;
+};
+
+class Reader
+{
+public:
+    explicit Reader(std::string_view in) : in_(in) {}
+
+    template <typename T>
+    T get()
+    {
+        T value{};
+        if (in_.size() - pos_ < sizeof(T)) {
+            ok_ = false;
+            pos_ = in_.size();
+            return value;
+        }
+        std::memcpy(&value, in_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+    std::string_view get_string()
+    {
+        const uint32_t length = get<uint32_t>();
+        if (in_.size() - pos_ < length) {
+            ok_ = false;
+            pos_ = in_.size();
+            return {};
+        }
+        const std::string_view s = in_.substr(pos_, length);
+        pos_ += length;
+        return s;
+    }
+    std::string_view rest() const { return in_.substr(pos_); }
+
+    bool ok() const { return ok_; }
+
+private:
+    std::string_view in_;
+    size_t pos_ = 0;
+    bool ok_ = true;
+};
+
+void encode_request(Writer& w, const SearchRequest& request)
+{
+    w.put_string(request.pattern);
+    w.put<uint32_t>(static_cast<uint32_t>(request.paths.size()));
+    for (const auto& path : request.paths) {
+        w.put_string(path_to_utf8(path));
+    }
+    w.put_string(request.include);
+    w.put_string(request.exclude);
+    w.put_string(request.extensions);
+    w.put<uint64_t>(request.min_file_size);
+    w.put<uint64_t>(request.max_file_size);
+    w.put<uint8_t>(request.whole_word);
+    w.put<uint8_t>(request.names_only);
+    w.put<uint8_t>(request.search_paks);
+    w.put<uint64_t>(request.max_results);
+    w.put<uint8_t>(request.prioritize_likely);
+    w.put<uint8_t>(request.physical_order);
+    w.put<uint32_t>(static_cast<uint32_t>(request.device_threads));
+    w.put<uint32_t>(static_cast<uint32_t>(request.prefetch_depth));
+    w.put<uint8_t>(request.adaptive_threads);
+    w.put<uint8_t>(request.background);
+    w.put<uint64_t>(request.background_bandwidth);
+    w.put<uint8_t>(request.case_sensitive);
+    w.put<uint32_t>(static_cast<uint32_t>(request.max_edits));
+    w.put<uint8_t>(request.count_matches);
+}
+
+bool decode_request(Reader& r, SearchRequest& request)
+{
+    request.pattern = r.get_string();
+    const uint32_t path_count = r.get<uint32_t>();
+    for (uint32_t i = 0; i < path_count && r.ok(); ++i) {
+        request.paths.push_back(path_from_utf8(r.get_string()));
+    }
+    request.include = r.get_string();
+    request.exclude = r.get_string();
+    request.extensions = r.get_string();
+    request.min_file_size = r.get<uint64_t>();
+    request.max_file_size = r.get<uint64_t>();
+    request.whole_word = r.get<uint8_t>() != 0;
+    request.names_only = r.get<uint8_t>() != 0;
+    request.search_paks = r.get<uint8_t>() != 0;
+    request.max_results = static_cast<size_t>(r.get<uint64_t>());
+    request.prioritize_likely = r.get<uint8_t>() != 0;
+    request.physical_order = r.get<uint8_t>() != 0;
+    request.device_threads = r.get<uint32_t>();
+    request.prefetch_depth = r.get<uint32_t>();
+    request.adaptive_threads = r.get<uint8_t>() != 0;
+    request.background = r.get<uint8_t>() != 0;
+    request.background_bandwidth = r.get<uint64_t>();
+    request.case_sensitive = r.get<uint8_t>() != 0;
+    request.max_edits = r.get<uint32_t>();
+    request.count_matches = r.get<uint8_t>() != 0;
+    return r.ok();
+}
+
+void encode_stats(Writer& w, const SearchStats& stats)
+{
+    w.put<uint64_t>(stats.files_scanned);
+    w.put<uint64_t>(stats.files_deduplicated);
+    w.put<uint64_t>(stats.cache_hits);
+    w.put<uint64_t>(stats.cache_misses);
+    w.put<uint64_t>(stats.cache_bytes);
+}
+
+void decode_stats(Reader& r, SearchStats& stats)
+{
+    stats.files_scanned = static_cast<size_t>(r.get<uint64_t>());
+    stats.files_deduplicated = static_cast<size_t>(r.get<uint64_t>());
+    stats.cache_hits = static_cast<size_t>(r.get<uint64_t>());
+    stats.cache_misses = static_cast<size_t>(r.get<uint64_t>());
+    stats.cache_bytes = static_cast<size_t>(r.get<uint64_t>());
+}
+
+void encode_result(Writer& w, const SearchResult& result)
+{
+    w.put<int32_t>(result.score);
+    w.put<uint64_t>(result.match_count);
+    w.put<uint8_t>(static_cast<uint8_t>((result.header_match ? 1 : 0) | (result.name_match ? 2 : 0)));
+    w.put_string(path_to_utf8(result.file_path));
+    w.put<uint64_t>(result.size);
+    w.put<int64_t>(result.mtime);
+    w.put<uint32_t>(result.root);
+    w.put<uint32_t>(result.edit_distance);
+}
+
+bool decode_results(Reader& r, uint64_t count, std::vector<SearchResult>& out)
+{
+    out.reserve(out.size() + static_cast<size_t>(std::min<uint64_t>(count, 1 << 20)));
+    for (uint64_t i = 0; i < count && r.ok(); ++i) {
+        const int32_t score = r.get<int32_t>();
+        const uint64_t match_count = r.get<uint64_t>();
+        const uint8_t flags = r.get<uint8_t>();
+        const std::string_view path = r.get_string();
+
+        SearchResult result(path_from_utf8(path));
+        result.size = r.get<uint64_t>();
+        result.mtime = r.get<int64_t>();
+        result.root = r.get<uint32_t>();
+        result.edit_distance = r.get<uint32_t>();
+        result.score = score;
+        result.match_count = static_cast<size_t>(match_count);
+        result.header_match = (flags & 1) != 0;
+        result.name_match = (flags & 2) != 0;
+        out.push_back(std::move(result));
+    }
+    return r.ok();
+}
+} // namespace
+
+SearchDaemon::SearchDaemon(std::filesystem::path socket_path) : socket_path_(std::move(socket_path))
+{
+}
+
+SearchDaemon::~SearchDaemon()
+{
+    stop();
+    wait_for_clients();
+}
+
+std::filesystem::path SearchDaemon::default_socket_path()
+{
+    const std::filesystem::path dir = SearchEngine::default_snapshot_dir();
+    return dir.empty() ? std::filesystem::path() : dir / "daemon.sock";
+}
+
+bool SearchDaemon::start(std::string& error)
+{
+    if (!listener_.listen(socket_path_, error)) {
+        return false;
+    }
+    running_ = true;
+    return true;
+}
+
+void SearchDaemon::run()
+{
+    while (running_) {
+        auto client = std::make_shared<LocalSocket>(listener_.accept());
+        if (!client->valid()) {
+            if (running_) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10)); // es. troppi fd aperti
+            }
+            continue;
+        }
+
+        std::scoped_lock<std::mutex> lock(clients_mutex_);
+        clients_.push_back(client);
+        std::thread(&SearchDaemon::serve, this, client).detach();
+    }
+
+    wait_for_clients();
+    listener_.close();
+}
+
+void SearchDaemon::stop()
+{
+    running_ = false;
+    listener_.shutdown();
+    engine_.stop_search();
+    background_engine_.stop_search();
+
+    std::scoped_lock<std::mutex> lock(clients_mutex_);
+    for (const auto& client : clients_) {
+        client->shutdown();
+    }
+}
+
+void SearchDaemon::wait_for_clients()
+{
+    std::unique_lock<std::mutex> lock(clients_mutex_);
+    clients_done_.wait(lock, [this] { return clients_.empty(); });
+}
+
+void SearchDaemon::serve(std::shared_ptr<LocalSocket> client)
+{
+    Frame type;
+    std::string payload;
+    while (running_ && recv_frame(*client, type, payload)) {
+        bool ok = false;
+        switch (type) {
+            case Frame::Ping:    ok = send_frame(*client, Frame::Pong, {}); break;
+            case Frame::Request: ok = handle_search(*client, payload); break;
+            default:             break; // frame inatteso: chiude
+        }
+        if (!ok) break;
+    }
+
+    client->close();
+    std::scoped_lock<std::mutex> lock(clients_mutex_);
+    clients_.erase(std::remove(clients_.begin(), clients_.end(), client), clients_.end());
+    clients_done_.notify_all();
+}
+
+bool SearchDaemon::handle_search(const LocalSocket& client, const std::string& payload)
+{
+    SearchRequest request;
+    Reader reader(payload);
+    if (!decode_request(reader, request)) {
+        return send_frame(client, Frame::Error, "malformed request");
+    }
+
+    std::vector<std::string> messages;
+    std::mutex messages_mutex;
+    std::vector<SearchResult> results;
+    SearchStats stats;
+    {
+        // Le ricerche in background hanno il loro motore: una in primo piano
+        // non resta in coda dietro a loro, anzi le mette in pausa
+        SearchEngine& engine = request.background ? background_engine_ : engine_;
+        std::scoped_lock<std::mutex> lock(request.background ? background_mutex_ : engine_mutex_);
+        engine.search(request, [&](const std::string& message, size_t, size_t total) {
+            if (total == 0) { // messaggi di stato/errore, non l'avanzamento
+                std::scoped_lock<std::mutex> messages_lock(messages_mutex);
+                messages.push_back(message);
+            }
+        });
+        results = engine.get_results();
+        stats = engine.get_stats();
+    }
+
+    Writer blob;
+    for (const auto& result : results) {
+        encode_result(blob, result);
+    }
+
+    Writer reply;
+    encode_stats(reply, stats);
+    reply.put<uint32_t>(static_cast<uint32_t>(messages.size()));
+    for (const auto& message : messages) {
+        reply.put_string(message);
+    }
+    reply.put<uint64_t>(results.size());
+
+    // Risultati grandi: il client li legge dalla memoria condivisa invece di
+    // farli passare dal socket, e conferma prima che il segmento sparisca
+    SharedMemory shared;
+    const std::string shared_name = SharedMemory::unique_name();
+    if (blob.str().size() <= kInlineLimit || !shared.create(shared_name, blob.str().size())) {
+        reply.put<uint8_t>(static_cast<uint8_t>(Transport::Inline));
+        reply.put_bytes(blob.str());
+        return send_frame(client, Frame::Results, reply.str());
+    }
+
+    std::memcpy(shared.data(), blob.str().data(), blob.str().size());
+    reply.put<uint8_t>(static_cast<uint8_t>(Transport::Shared));
+    reply.put_string(shared_name);
+    reply.put<uint64_t>(blob.str().size());
+
+    Frame type;
+    std::string ack;
+    return send_frame(client, Frame::Results, reply.str()) &&
+           recv_frame(client, type, ack) && type == Frame::Ack;
+}
+
+bool SearchClient::connect(const std::filesystem::path& socket_path)
+{
+    std::lock_guard<std::mutex> lock(socket_mutex_);
+    return !socket_path.empty() && socket_.connect(socket_path);
+}
+
+void SearchClient::disconnect()
+{
+    std::lock_guard<std::mutex> lock(socket_mutex_);
+    socket_.close();
+}
+
+void SearchClient::interrupt()
+{
+    std::lock_guard<std::mutex> lock(socket_mutex_);
+    socket_.shutdown();
+}
+
+bool SearchClient::ping()
+{
+    Frame type;
+    std::string payload;
+    if (!connected() || !send_frame(socket_, Frame::Ping, {}) || !recv_frame(socket_, type, payload) ||
+        type != Frame::Pong) {
+        disconnect();
+        return false;
+    }
+    return true;
+}
+
+bool SearchClient::search(const SearchRequest& request, Reply& reply)
+{
+    reply = Reply{};
+    if (!connected()) {
+        return false;
+    }
+
+    SearchRequest absolute = request;
+    for (auto& path : absolute.paths) {
+        std::error_code ec;
+        const auto resolved = std::filesystem::absolute(path, ec);
+        if (!ec) path = resolved;
+    }
+
+    Writer writer;
+    encode_request(writer, absolute);
+
+    Frame type;
+    std::string payload;
+    if (!send_frame(socket_, Frame::Request, writer.str()) || !recv_frame(socket_, type, payload)) {
+        disconnect();
+        return false;
+    }
+    if (type == Frame::Error) {
+        reply.messages.push_back(payload);
+        return true;
+    }
+    if (type != Frame::Results) {
+        disconnect();
+        return false;
+    }
+
+    Reader reader(payload);
+    decode_stats(reader, reply.stats);
+    const uint32_t message_count = reader.get<uint32_t>();
+    for (uint32_t i = 0; i < message_count && reader.ok(); ++i) {
+        reply.messages.emplace_back(reader.get_string());
+    }
+    const uint64_t count = reader.get<uint64_t>();
+    const auto transport = static_cast<Transport>(reader.get<uint8_t>());
+
+    bool ok = reader.ok();
+    if (ok && transport == Transport::Shared) {
+        const std::string name(reader.get_string());
+        const uint64_t size = reader.get<uint64_t>();
+        SharedMemory shared;
+        ok = reader.ok() && shared.open(name, static_cast<size_t>(size));
+        if (ok) {
+            Reader blob(std::string_view(shared.data(), shared.size()));
+            ok = decode_results(blob, count, reply.results);
+        }
+        shared.close();
+        ok = send_frame(socket_, Frame::Ack, {}) && ok;
+    } else if (ok) {
+        Reader blob(reader.rest());
+        ok = decode_results(blob, count, reply.results);
+    }
+
+    if (!ok) {
+        disconnect();
+    }
+    return ok;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "LocalIpc.h"
+#include "SearchEngine.h"
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Daemon residente: un solo SearchEngine (con indice dei nomi, hash dei
+// contenuti e ContentCache già caldi) condiviso da più GUI e script.
+//
+// I client parlano su un socket Unix locale con frame binari; i risultati
+// piccoli tornano sul socket, quelli grandi in un segmento di memoria
+// condivisa che il client legge e conferma. Le ricerche sullo stesso motore
+// sono serializzate: due client che cercano insieme si mettono in coda.
+// Le ricerche in background (SearchRequest::background) usano un secondo
+// motore, così una ricerca in primo piano parte subito e le mette in pausa.
+class SearchDaemon
+{
+public:
+    explicit SearchDaemon(std::filesystem::path socket_path = default_socket_path());
+    ~SearchDaemon();
+
+    // Socket di default nella directory privata dell'utente (private_temp_dir),
+    // condiviso da GUI e CLI; vuoto se la directory non è utilizzabile
+    static std::filesystem::path default_socket_path();
+
+    SearchEngine &engine() { return engine_; }
+    SearchEngine &background_engine() { return background_engine_; }
+
+    bool start(std::string &error);
+    void run(); // blocca finché stop() non viene chiamato
+    void stop();
+
+private:
+    void wait_for_clients();
+    void serve(std::shared_ptr<LocalSocket> client);
+    bool handle_search(const LocalSocket &client, const std::string &payload);
+
+    std::filesystem::path socket_path_;
+    LocalSocket listener_;
+    std::atomic<bool> running_{false};
+
+    std::mutex engine_mutex_; // una ricerca alla volta
+    SearchEngine engine_;
+    std::mutex background_mutex_;
+    SearchEngine background_engine_;
+
+    // Un thread per connessione; stop() li sblocca chiudendo i socket e
+    // aspetta che ognuno si tolga dalla lista
+    std::mutex clients_mutex_;
+    std::condition_variable clients_done_;
+    std::vector<std::shared_ptr<LocalSocket>> clients_;
+};
+
+// Client del daemon. Una connessione resta aperta tra una ricerca e l'altra;
+// le chiamate vanno fatte da un thread alla volta, salvo interrupt().
+class SearchClient
+{
+public:
+    struct Reply
+    {
+        std::vector<SearchResult> results;
+        SearchStats stats;
+        std::vector<std::string> messages; // errori e avvisi del motore (path mancanti, regex)
+    };
+
+    bool connect(const std::filesystem::path &socket_path = SearchDaemon::default_socket_path());
+    void disconnect();
+    bool connected() const { return socket_.valid(); }
+    // Da un altro thread: fa fallire la search() in corso, che chiude la
+    // connessione (il daemon se ne accorge al primo invio)
+    void interrupt();
+
+    // I path relativi vengono risolti qui: il daemon ha un'altra working dir.
+    // false se la connessione cade; la si può riaprire con connect().
+    bool search(const SearchRequest &request, Reply &reply);
+    bool ping();
+
+private:
+    std::mutex socket_mutex_; // connect/close contro interrupt()
+    LocalSocket socket_;
+};
@@ -1,11 +1,38 @@
 #include "SearchEngine.h"
+#include "ContentDedup.h"
+#include "DiskLayout.h"
+#include "FileSnapshot.h"
+#include "LocalIpc.h"
+#include "MappedFile.h"
+#include "PakFile.h"
+#include "ResultChannel.h"
+#include <chrono>
+#include <condition_variable>
 #include <thread>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <numeric>
+#include <optional>
+#include <deque>
 #include <queue>
 #include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <bit>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SEARCHENGINE_SSE2 1
+#endif
+
+// Ogni quanti byte la scansione letterale di un file controlla lo stop
+static constexpr size_t kStopCheckBytes = 256 * 1024;
 
 // Un pattern è "letterale" se non contiene metacaratteri regex: in tal caso
 // possiamo cercarlo come semplice substring, evitando del tutto std::regex.
@@ -32,17 +59,380 @@ static std::string to_lower_copy(const std::string& s)
     return out;
 }
 
+// Nome di un file della FileTable per le regole e i .pak, che lavorano su
+// stringhe strette: su Windows i nomi nativi sono UTF-16
 #ifdef _WIN32
-#ifndef NOMINMAX
-#define NOMINMAX
+static std::string narrow_name(FileTable::StringView name)
+{
+    return std::filesystem::path(name).string();
+}
+#else
+static std::string_view narrow_name(FileTable::StringView name)
+{
+    return name;
+}
 #endif
-#include <windows.h>
+
+// Tabelle per byte calcolate a compile time: folding ASCII (i byte non ASCII
+// restano invariati) e caratteri di identificatore per il controllo
+// whole-word (lettere, numeri, underscore e trattino)
+struct ByteTables
+{
+    unsigned char fold[256];
+    bool identifier[256];
+};
+
+static constexpr ByteTables make_byte_tables()
+{
+    ByteTables t{};
+    for (int c = 0; c < 256; ++c) {
+        const bool upper = c >= 'A' && c <= 'Z';
+        const bool lower = c >= 'a' && c <= 'z';
+        const bool digit = c >= '0' && c <= '9';
+        t.fold[c] = static_cast<unsigned char>(upper ? (c | 0x20) : c);
+        t.identifier[c] = upper || lower || digit || c == '_' || c == '-';
+    }
+    return t;
+}
+
+static constexpr ByteTables kByteTables = make_byte_tables();
+
+static inline bool is_identifier_char(char c)
+{
+    return kByteTables.identifier[static_cast<unsigned char>(c)];
+}
+
+template <bool CaseSensitive>
+static inline unsigned char fold_ascii(unsigned char c)
+{
+    if constexpr (CaseSensitive) {
+        return c;
+    } else {
+        return kByteTables.fold[c];
+    }
+}
+
+static inline unsigned char upper_ascii(unsigned char c)
+{
+    return (c >= 'a' && c <= 'z') ? static_cast<unsigned char>(c & ~0x20) : c;
+}
+
+// Pattern UTF-8 → byte UTF-16LE, per trovare le FString che Unreal
+// serializza in UTF-16 (quelle con caratteri non ASCII). ASCII già in minuscolo.
+static std::string to_utf16le(const std::string& utf8)
+{
+    std::string out;
+    size_t i = 0;
+    while (i < utf8.size()) {
+        const unsigned char c = static_cast<unsigned char>(utf8[i]);
+        uint32_t cp = c;
+        size_t len = 1;
+        if (c >= 0xF0) { cp = c & 0x07; len = 4; }
+        else if (c >= 0xE0) { cp = c & 0x0F; len = 3; }
+        else if (c >= 0xC0) { cp = c & 0x1F; len = 2; }
+        if (i + len > utf8.size()) { cp = c; len = 1; } // sequenza troncata: byte così com'è
+        for (size_t k = 1; k < len; ++k) {
+            cp = (cp << 6) | (static_cast<unsigned char>(utf8[i + k]) & 0x3F);
+        }
+        i += len;
+
+        auto put = [&out](uint32_t unit) {
+            out.push_back(static_cast<char>(unit & 0xFF));
+            out.push_back(static_cast<char>(unit >> 8));
+        };
+        if (cp >= 0x10000) {
+            cp -= 0x10000;
+            put(0xD800 | (cp >> 10));
+            put(0xDC00 | (cp & 0x3FF));
+        } else {
+            put(cp);
+        }
+    }
+    return out;
+}
+
+// needle già in minuscolo se !CaseSensitive
+template <bool CaseSensitive>
+static inline bool equal_narrow(const char* hay, const std::string& needle)
+{
+    for (size_t k = 0; k < needle.size(); ++k) {
+        if (fold_ascii<CaseSensitive>(static_cast<unsigned char>(hay[k])) != static_cast<unsigned char>(needle[k]))
+            return false;
+    }
+    return true;
+}
+
+// Confronto per code unit UTF-16LE: il folding vale solo per le unit ASCII
+// (byte alto zero), altrimenti il byte basso di U+0141 combacerebbe con U+0161.
+template <bool CaseSensitive>
+static inline bool equal_wide(const char* hay, const std::string& wide)
+{
+    for (size_t k = 0; k < wide.size(); k += 2) {
+        const unsigned char lo = static_cast<unsigned char>(hay[k]);
+        const unsigned char hi = static_cast<unsigned char>(hay[k + 1]);
+        const unsigned char nlo = static_cast<unsigned char>(wide[k]);
+        const unsigned char nhi = static_cast<unsigned char>(wide[k + 1]);
+        if (hi != nhi) return false;
+        if ((nhi == 0 ? fold_ascii<CaseSensitive>(lo) : lo) != nlo) return false;
+    }
+    return true;
+}
+
+struct LiteralHit
+{
+    size_t pos = std::string::npos;
+    size_t length = 0;
+    bool   wide = false; // trovato come UTF-16LE
+};
+
+// Prossima occorrenza del pattern, come UTF-8 (narrow) o come UTF-16LE
+// (wide), in un solo passaggio su hay[from, n). Il filtro SIMD guarda i primi
+// due byte di entrambe le codifiche insieme ('W','e' oppure 'W','\0'); la
+// verifica completa avviene solo sui candidati.
+template <bool CaseSensitive>
+static LiteralHit find_literal(const char* hay, size_t n, size_t from,
+                               const std::string& narrow, const std::string& wide)
+{
+    // Prima la forma wide: un pattern di un carattere combacia in entrambe,
+    // e i vicini vanno letti come code unit
+    auto verify = [&](size_t i) -> LiteralHit {
+        if (i + wide.size() <= n && equal_wide<CaseSensitive>(hay + i, wide))       return {i, wide.size(), true};
+        if (i + narrow.size() <= n && equal_narrow<CaseSensitive>(hay + i, narrow)) return {i, narrow.size(), false};
+        return {};
+    };
+
+    size_t i = from;
+#ifdef SEARCHENGINE_SSE2
+    const unsigned char n0 = static_cast<unsigned char>(narrow[0]);
+    const unsigned char w0 = static_cast<unsigned char>(wide[0]);
+    const unsigned char w1 = static_cast<unsigned char>(wide[1]);
+    const __m128i n0_lo = _mm_set1_epi8(static_cast<char>(n0));
+    const __m128i n0_up = _mm_set1_epi8(static_cast<char>(upper_ascii(n0)));
+    const __m128i w0_lo = _mm_set1_epi8(static_cast<char>(w0));
+    const __m128i w0_up = _mm_set1_epi8(static_cast<char>(w1 == 0 ? upper_ascii(w0) : w0));
+    const __m128i w1_v  = _mm_set1_epi8(static_cast<char>(w1));
+    // Pattern di un solo byte: il secondo filtro accetta tutto
+    const bool has_n1 = narrow.size() >= 2;
+    const unsigned char n1 = has_n1 ? static_cast<unsigned char>(narrow[1]) : 0;
+    const __m128i n1_lo = _mm_set1_epi8(static_cast<char>(n1));
+    const __m128i n1_up = _mm_set1_epi8(static_cast<char>(upper_ascii(n1)));
+    const __m128i all   = _mm_set1_epi8(-1);
+
+    // Case-sensitive: il byte così com'è, senza la variante maiuscola
+    auto either = [](__m128i v, __m128i lo, __m128i up) {
+        if constexpr (CaseSensitive) {
+            (void)up;
+            return _mm_cmpeq_epi8(v, lo);
+        } else {
+            return _mm_or_si128(_mm_cmpeq_epi8(v, lo), _mm_cmpeq_epi8(v, up));
+        }
+    };
+
+    for (; i + 1 + 16 <= n; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hay + i + 1));
+        const __m128i first = _mm_or_si128(either(a, n0_lo, n0_up), either(a, w0_lo, w0_up));
+        const __m128i second_narrow = has_n1 ? either(b, n1_lo, n1_up) : all;
+        const __m128i second = _mm_or_si128(second_narrow, _mm_cmpeq_epi8(b, w1_v));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(first, second)));
+        while (mask != 0) {
+            const unsigned bit = static_cast<unsigned>(std::countr_zero(mask));
+            const LiteralHit hit = verify(i + bit);
+            if (hit.pos != std::string::npos) return hit;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        const LiteralHit hit = verify(i);
+        if (hit.pos != std::string::npos) return hit;
+    }
+    return {};
+}
+
+// Dimensione dell'header di un package Unreal (.uasset/.umap): summary, name
+// table, import ed export map. Un match qui dentro è un riferimento "vero"
+// (nome o classe importata), uno oltre è solo nei dati serializzati.
+// Ritorna 0 se il buffer non è un package riconosciuto. file_size: del
+// package intero, se il buffer ne è solo l'inizio.
+static size_t uasset_header_size(const char* data, size_t size, size_t file_size = 0)
+{
+    constexpr uint32_t kPackageFileTag    = 0x9E2A83C1;
+    constexpr int32_t  kUE5PackageSavedHash = 1016; // EUnrealEngineObjectUE5Version::PACKAGE_SAVED_HASH
+
+    size_t pos = 0;
+    auto read_i32 = [&](int32_t& out) -> bool {
+        if (pos + 4 > size) return false;
+        std::memcpy(&out, data + pos, 4);
+        pos += 4;
+        return true;
+    };
+
+    int32_t tag = 0, legacy = 0, dummy = 0, ue5 = 0, total_header = 0;
+    if (!read_i32(tag) || static_cast<uint32_t>(tag) != kPackageFileTag) return 0;
+    if (!read_i32(legacy) || legacy >= 0 || legacy < -9) return 0;
+    if (legacy != -4 && !read_i32(dummy)) return 0;         // LegacyUE3Version
+    if (!read_i32(dummy)) return 0;                         // FileVersionUE4
+    if (legacy <= -8 && !read_i32(ue5)) return 0;           // FileVersionUE5
+    if (!read_i32(dummy)) return 0;                         // FileVersionLicenseeUE4
+
+    const bool saved_hash = ue5 >= kUE5PackageSavedHash;
+    if (saved_hash) {
+        pos += 20;                                          // SavedHash (FIoHash)
+        if (!read_i32(total_header)) return 0;
+    }
+    if (legacy <= -2) {
+        int32_t custom_count = 0;                           // CustomVersions: FGuid + int32
+        if (!read_i32(custom_count) || custom_count < 0) return 0;
+        pos += static_cast<size_t>(custom_count) * 20;
+    }
+    if (!saved_hash && !read_i32(total_header)) return 0;
+
+    if (total_header <= 0 || static_cast<size_t>(total_header) > std::max(size, file_size)) return 0;
+    return static_cast<size_t>(total_header);
+}
+
+// Finestra di prefetch su una lista in scansione: chi prende il file j si
+// assicura che i successivi depth siano già stati chiesti al kernel. Il fronte
+// avanza con un CAS, così ogni file viene chiesto una volta sola.
+class PrefetchWindow
+{
+public:
+    PrefetchWindow(const FileTable& table, const FileEntry* const* files, size_t count, size_t depth)
+        : table_(table), files_(files), count_(count), depth_(depth) {}
+
+    void advance(size_t current)
+    {
+        if (depth_ == 0) return;
+        const size_t target = std::min(current + 1 + depth_, count_);
+        size_t from = issued_.load(std::memory_order_relaxed);
+        while (from < target && !issued_.compare_exchange_weak(from, target)) {
+        }
+        thread_local FileTable::String path; // riusato: nessuna allocazione per file
+        for (size_t k = std::max(from, current + 1); k < target; ++k) {
+            path.clear();
+            table_.append_path(*files_[k], path);
+            MappedFile::prefetch(path.c_str());
+        }
+    }
+
+private:
+    const FileTable& table_;
+    const FileEntry* const* files_;
+    size_t count_;
+    size_t depth_;
+    std::atomic<size_t> issued_{0};
+};
+
+// Size, mtime e inode attuali di un file, nelle stesse unità del walk.
+// false se il file non si può leggere (es. cancellato dopo lo snapshot).
+static bool stat_entry(const std::filesystem::path::value_type* path, FileEntry& file)
+{
+#ifdef _WIN32
+    std::error_code ec;
+    const uint64_t size = std::filesystem::file_size(path, ec);
+    if (ec) return false;
+    const auto mtime = std::filesystem::last_write_time(path, ec);
+    if (ec) return false;
+    file.size = size;
+    file.mtime = mtime.time_since_epoch().count();
 #else
-#include <sys/mman.h>
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <unistd.h>
+    // Un solo stat per size, mtime e inode
+    struct stat sb;
+    if (::stat(path, &sb) != 0) return false;
+    file.size = static_cast<uint64_t>(sb.st_size);
+    file.mtime = static_cast<int64_t>(sb.st_mtim.tv_sec) * 1000000000 + sb.st_mtim.tv_nsec;
+    file.inode = static_cast<uint64_t>(sb.st_ino);
+    file.device = static_cast<uint64_t>(sb.st_dev);
+#endif
+    return true;
+}
+
+// Inizio del path di una entry di un .pak (mount point + path) da passare
+// alle regole del walk: dopo la prima cartella "Content", come per un file
+// su disco sotto una root Content; tutto il path se non ce n'è
+static size_t pak_filter_start(std::string_view full)
+{
+    static constexpr std::string_view kContent = "Content/";
+    for (size_t pos = 0; (pos = full.find(kContent, pos)) != std::string_view::npos; pos += kContent.size()) {
+        if (pos == 0 || full[pos - 1] == '/') {
+            return pos + kContent.size();
+        }
+    }
+    return 0;
+}
+
+// mtime del walk (unità native, vedi FileEntry) → secondi Unix per i risultati
+static int64_t unix_seconds(int64_t mtime)
+{
+    if (mtime == 0) {
+        return 0;
+    }
+#ifdef _WIN32
+    const std::filesystem::file_time_type time{std::filesystem::file_time_type::duration(mtime)};
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::clock_cast<std::chrono::system_clock>(time).time_since_epoch()).count();
+#else
+    return mtime / 1000000000;
 #endif
+}
+
+// Indice della root che contiene file (la più lunga, se annidate); 0 se nessuna
+static uint32_t root_index(const std::vector<std::filesystem::path>& roots, const std::filesystem::path& file)
+{
+    uint32_t best = 0;
+    size_t best_length = 0;
+    const auto& native = file.native();
+    for (size_t i = 0; i < roots.size(); ++i) {
+        const auto& root = roots[i].native();
+        if (root.size() > best_length && native.compare(0, root.size(), root) == 0) {
+            best = static_cast<uint32_t>(i);
+            best_length = root.size();
+        }
+    }
+    return best;
+}
+
+// Punteggio di rilevanza: il nome del file pesa più di tutto, poi la
+// posizione del match (header vs dati) e infine il numero di occorrenze.
+static int compute_score(const std::filesystem::path& file_path,
+                         const std::string& literal_lower,
+                         const SearchResult& result)
+{
+    int score = 0;
+
+    if (result.name_match) {
+        score += 250;
+        if (!literal_lower.empty()) {
+            const std::string stem = to_lower_copy(file_path.stem().string());
+            if (stem == literal_lower) {
+                score += 750;                               // Weapon.uasset
+            } else {
+                // BP_Weapon, Weapon_C: il pattern è un "token" completo del nome
+                const size_t at = stem.find(literal_lower);
+                if (at != std::string::npos) {
+                    const size_t end = at + literal_lower.size();
+                    const bool starts = at == 0 || !std::isalnum(static_cast<unsigned char>(stem[at - 1]));
+                    const bool ends = end == stem.size() || !std::isalnum(static_cast<unsigned char>(stem[end]));
+                    if (starts && ends) score += 250;
+                }
+            }
+        }
+    }
+
+    if (result.header_match) score += 100;
+
+    // Ricerca approssimata: ogni errore pesa quanto un match nell'header
+    score -= 100 * static_cast<int>(result.edit_distance);
+
+    // log2 delle occorrenze: 1 → 0, 2 → 10, 4 → 20, ... 64 → 60
+    size_t n = result.match_count;
+    int log2 = 0;
+    while (n > 1) { n >>= 1; ++log2; }
+    score += 10 * log2;
+
+    return score;
+}
 
 SearchEngine::SearchEngine() : thread_count_(std::thread::hardware_concurrency()) {
     if (thread_count_ == 0) thread_count_ = 4;
@@ -63,16 +453,112 @@ void SearchEngine::search(const std::string& search_pattern,
     searching_ = true;
     stop_requested_ = false;
     clear_results();
+    inode_table_.clear();
+    content_table_.clear();
+    stats_files_scanned_ = 0;
+    stats_files_deduplicated_ = 0;
+    stats_cache_hits_ = 0;
+    stats_cache_misses_ = 0;
+    reported_ = 0;
+    search_roots_ = search_paths;
+    arena_.reset();
+    progress_.start();
+    device_slots_.set_limit(m_deviceThreads);
+
+    // In primo piano: le ricerche in background del processo aspettano
+    std::optional<SearchQos::ForegroundScope> foreground;
+    if (m_background) {
+        throttle_.reset(m_backgroundBandwidth);
+    } else {
+        foreground.emplace();
+    }
+
+    if (m_namesOnly) {
+        search_names(search_pattern, search_paths, progress_cb, result_cb);
+        progress_.finish();
+        searching_ = false;
+        return;
+    }
+
+    // Query booleana: una non valida non fa partire il walk
+    m_isQuery = BooleanQuery::looks_like_query(search_pattern);
+    if (m_isQuery) {
+        std::string query_error;
+        if (!m_query.parse(search_pattern, m_caseSensitive, query_error)) {
+            if (progress_cb) {
+                progress_cb("Invalid query: " + query_error, 0, 0);
+            }
+            progress_.finish();
+            searching_ = false;
+            return;
+        }
+    }
+
+    // Il walk di questa ricerca ricostruisce anche l'indice dei nomi
+    {
+        std::scoped_lock<std::mutex> lock(path_index_mutex_);
+        path_index_.clear();
+        path_index_roots_ = search_paths;
+        path_index_filter_ = walk_signature();
+        path_index_complete_ = false;
+    }
 
     try {
         // Fast-path: pattern letterale → ricerca substring, niente regex.
-        m_isLiteral = is_literal_pattern(search_pattern);
-        if (m_isLiteral) {
+        m_isLiteral = !m_isQuery && is_literal_pattern(search_pattern);
+        if (m_isQuery) {
+            // Ranking sul nome e ordine di scansione seguono il primo termine
+            m_literalLower = to_lower_copy(m_query.primary_term());
+            m_literalNeedle = m_caseSensitive ? m_query.primary_term() : m_literalLower;
+            m_literalWide.clear();
+            m_approximate = ApproximatePattern();
+        } else if (m_isLiteral) {
             m_literalLower = to_lower_copy(search_pattern);
+            m_literalNeedle = m_caseSensitive ? search_pattern : m_literalLower;
+            m_literalWide = to_utf16le(m_literalNeedle);
+            m_approximate = m_maxEdits > 0 ? ApproximatePattern(search_pattern, m_maxEdits, m_caseSensitive)
+                                           : ApproximatePattern();
         } else {
-            // Use case insensitive regex
-            compiled_pattern_ = std::regex(search_pattern, std::regex_constants::icase);
+            m_approximate = ApproximatePattern();
+            m_literalLower.clear();
+            m_literalNeedle.clear();
+            m_literalWide.clear();
+            compiled_pattern_ = m_caseSensitive
+                ? std::regex(search_pattern)
+                : std::regex(search_pattern, std::regex_constants::icase);
         }
+        scan_kernel_ = select_scan_kernel();
+        range_kernel_ = select_range_kernel();
+        if (m_prioritizeLikely) {
+            scan_order_ = ScanOrder(m_literalLower, hit_history_.hints_for(search_pattern));
+        }
+        // Thread adattivi: si parte dal valore ricordato per il volume e un
+        // controller campiona il progresso finché la ricerca non finisce
+        std::unique_ptr<ConcurrencyTuner> tuner;
+        std::thread controller;
+        std::mutex controller_mutex;
+        std::condition_variable controller_wake;
+        bool controller_done = false;
+        const std::string device = m_adaptiveThreads && !search_paths.empty()
+                                       ? DiskLayout::device_key(search_paths.front()) : std::string();
+        const std::filesystem::path memory_file =
+            snapshot_dir_.empty() ? std::filesystem::path() : snapshot_dir_ / "concurrency.txt";
+        if (m_adaptiveThreads) {
+            if (!concurrency_loaded_ && !memory_file.empty()) {
+                concurrency_memory_.load(memory_file);
+                concurrency_loaded_ = true;
+            }
+            tuner = std::make_unique<ConcurrencyTuner>(thread_count_, concurrency_memory_.find(device));
+            tuner_ = tuner.get();
+            controller = std::thread([&]() {
+                std::unique_lock<std::mutex> lock(controller_mutex);
+                while (!controller_wake.wait_for(lock, std::chrono::milliseconds(250), [&]() { return controller_done; })) {
+                    const SearchProgress::Snapshot p = progress_.snapshot();
+                    tuner->sample(p.bytes_done, p.files_done);
+                }
+            });
+        }
+
         std::vector<std::future<void>> futures;
 
         for (const auto& path : search_paths) {
@@ -95,6 +581,30 @@ void SearchEngine::search(const std::string& search_pattern,
         for (const auto& future : futures) {
             future.wait();
         }
+
+        if (tuner) {
+            {
+                std::scoped_lock<std::mutex> lock(controller_mutex);
+                controller_done = true;
+            }
+            controller_wake.notify_one();
+            controller.join();
+            tuner->release();
+            tuner_ = nullptr;
+            if (tuner->best() > 0) {
+                concurrency_memory_.store(device, tuner->best());
+                if (!memory_file.empty()) {
+                    concurrency_memory_.save(memory_file);
+                }
+            }
+        }
+
+        {
+            std::scoped_lock<std::mutex> lock(results_mutex_);
+            hit_history_.record(search_pattern, recent_hits_);
+        }
+        std::scoped_lock<std::mutex> lock(path_index_mutex_);
+        path_index_complete_ = !stop_requested_;
     } catch (const std::regex_error& e) {
         std::string error_msg = "Invalid regex pattern: " + std::string(e.what());
         if (progress_cb) {
@@ -102,9 +612,86 @@ void SearchEngine::search(const std::string& search_pattern,
         }
     }
 
+    progress_.finish();
+    arena_.reset();
     searching_ = false;
 }
 
+void SearchEngine::search(const SearchRequest& request,
+                          const ProgressCallback& progress_cb,
+                          const ResultCallback& result_cb) {
+    if (searching_) {
+        return;
+    }
+    set_file_size_limits(request.min_file_size, request.max_file_size);
+    set_match_whole_word(request.whole_word);
+    set_case_sensitive(request.case_sensitive);
+    set_max_edits(request.max_edits);
+    set_names_only(request.names_only);
+    set_search_paks(request.search_paks);
+    set_max_results(request.max_results);
+    set_count_matches(request.count_matches);
+    set_prioritize_likely(request.prioritize_likely);
+    set_physical_order(request.physical_order, request.device_threads);
+    set_prefetch_depth(request.prefetch_depth);
+    set_adaptive_threads(request.adaptive_threads);
+    set_background(request.background, request.background_bandwidth);
+    set_file_filter(FileFilter::compile(request.include, request.exclude, request.extensions));
+    search(request.pattern, request.paths, progress_cb, result_cb);
+}
+
+Generator<std::vector<SearchResult>> SearchEngine::stream(SearchRequest request,
+                                                         size_t batch_size,
+                                                         size_t capacity,
+                                                         ProgressCallback progress_cb) {
+    if (searching_) {
+        co_return;
+    }
+
+    ResultChannel channel(capacity);
+    m_retainResults = false;
+    std::thread producer([this, &channel, &request, &progress_cb]() {
+        search(request, progress_cb, [this, &channel](const SearchResult& result) {
+            if (!channel.push(result)) {
+                stop_search(); // il consumatore ha smesso di leggere
+            }
+        });
+        channel.finish();
+    });
+
+    // Eseguito anche se il generatore viene distrutto prima della fine:
+    // sblocca i worker fermi sulla coda piena e aspetta la ricerca
+    struct ProducerGuard
+    {
+        SearchEngine& engine;
+        ResultChannel& channel;
+        std::thread& producer;
+        ~ProducerGuard()
+        {
+            channel.cancel();
+            engine.stop_search();
+            producer.join();
+            engine.m_retainResults = true;
+        }
+    } guard{*this, channel, producer};
+
+    std::vector<SearchResult> batch;
+    while (channel.pop_batch(batch, batch_size)) {
+        co_yield std::move(batch);
+        batch = {};
+    }
+}
+
+SearchStats SearchEngine::get_stats() const {
+    SearchStats stats;
+    stats.files_scanned = stats_files_scanned_.load();
+    stats.files_deduplicated = stats_files_deduplicated_.load();
+    stats.cache_hits = stats_cache_hits_.load();
+    stats.cache_misses = stats_cache_misses_.load();
+    stats.cache_bytes = content_cache_.used_bytes();
+    return stats;
+}
+
 void SearchEngine::stop_search() {
     stop_requested_ = true;
 }
@@ -112,188 +699,363 @@ void SearchEngine::stop_search() {
 void SearchEngine::clear_results() {
     std::scoped_lock<std::mutex> lock(results_mutex_);
     results_.clear();
+    recent_hits_.clear();
 }
 
-void SearchEngine::search_file(const std::filesystem::path& file_path,
+void SearchEngine::search_file(const FileEntry& file, const ScannedFile& target,
                               const ResultCallback& result_cb) {
+    const PathView path = target.path;
     if (stop_requested_) {
         return;
     }
 
-    // Check file size before processing
-    std::error_code ec;
-    auto file_size_check = std::filesystem::file_size(file_path, ec);
-    if (ec || file_size_check < min_file_size_ || file_size_check > max_file_size_) {
+    // Size letta durante il walk (o riletta, per lo snapshot): nessuno stat qui
+    if (file.size < min_file_size_ || file.size > max_file_size_) {
         return;  // Skip files outside size limits or with errors
     }
 
-    try {
-        // Use memory-mapped file for better performance
-        const char* file_data = nullptr;
-        size_t file_size = 0;
+    // Dedup: stesso inode (hardlink, symlink) o stesso contenuto già visto.
+    // Una copia identica eredita il verdetto senza essere riaperta.
+    ContentVerdict verdict;
+    bool have_verdict = false;
+    bool own_inode = false, own_content = false;
+    // mtime e size nella chiave: un file riscritto durante la ricerca (e
+    // ripassato dal delta dello snapshot) non eredita il verdetto di prima
+    const uint64_t inode_key = file.inode != 0
+        ? (file.inode * 0x9E3779B97F4A7C15ull) ^ file.device ^
+          (static_cast<uint64_t>(file.mtime) * 0xC2B2AE3D27D4EB4Full) ^ (file.size << 1)
+        : 0;
+    uint64_t hash = 0;
+    const bool hash_known = hash_cache_.lookup(path, file.size, file.mtime, hash);
 
-#ifdef _WIN32
-        HANDLE hFile = CreateFileA(file_path.string().c_str(), GENERIC_READ, FILE_SHARE_READ,
-                                   nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
-        if (hFile == INVALID_HANDLE_VALUE) {
-            return;
+    if (inode_key != 0) {
+        switch (inode_table_.claim(inode_key, &target, verdict)) {
+            case DedupTable::Claim::Done:    have_verdict = true; break;
+            case DedupTable::Claim::Waiting: ++stats_files_deduplicated_; return; // lo riporta l'owner
+            case DedupTable::Claim::Owner:   own_inode = true; break;
         }
+    }
+    if (!have_verdict && hash_known) {
+        // Se possediamo l'inode non ci si può accodare: altri aspettano noi
+        switch (content_table_.claim(hash, own_inode ? nullptr : &target, verdict)) {
+            case DedupTable::Claim::Done:    have_verdict = true; break;
+            case DedupTable::Claim::Waiting:
+                if (!own_inode) { ++stats_files_deduplicated_; return; }
+                break;
+            case DedupTable::Claim::Owner:   own_content = true; break;
+        }
+    }
 
-        HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
-        if (hMapping == nullptr) {
-            CloseHandle(hFile);
-            return;
+    if (have_verdict) {
+        ++stats_files_deduplicated_;
+    } else {
+        // Se la lettura fallisce le copie in coda restano senza match:
+        // il verdetto vuoto le sblocca comunque
+        uint64_t scanned_hash = 0;
+        if (scan_file(target, verdict, scanned_hash)) {
+            ++stats_files_scanned_;
+            hash_cache_.store(path, file.size, file.mtime, scanned_hash);
+            if (!own_content) {
+                content_table_.publish_if_absent(scanned_hash, verdict);
+            }
         }
+    }
 
-        file_data = static_cast<const char*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
-        if (file_data == nullptr) {
-            CloseHandle(hMapping);
-            CloseHandle(hFile);
-            return;
+    report_match(target, verdict, result_cb);
+
+    if (own_inode) {
+        for (const auto& waiter : inode_table_.publish(inode_key, verdict)) {
+            report_match(waiter, verdict, result_cb);
+        }
+    }
+    if (own_content) {
+        for (const auto& waiter : content_table_.publish(hash, verdict)) {
+            report_match(waiter, verdict, result_cb);
         }
+    }
+}
 
-        LARGE_INTEGER fileSize;
-        if (!GetFileSizeEx(hFile, &fileSize)) {
-            UnmapViewOfFile(file_data);
-            CloseHandle(hMapping);
-            CloseHandle(hFile);
-            return;
+bool SearchEngine::scan_file(const ScannedFile& target, ContentVerdict& verdict, uint64_t& hash) {
+    // Contenuto già in memoria da una ricerca precedente: niente open/mmap.
+    // Size e mtime di target sono quelli attuali anche per i file dello
+    // snapshot (vedi scan_files), non quelli salvati.
+    const PathView path = target.path;
+    if (content_cache_.enabled()) {
+        if (auto cached = content_cache_.find(path, target.size, target.mtime)) {
+            ++stats_cache_hits_;
+            hash = cached->hash;
+            scan_content(cached->bytes.data(), cached->bytes.size(), verdict);
+            return true;
         }
-        file_size = static_cast<size_t>(fileSize.QuadPart);
+        ++stats_cache_misses_;
+    }
 
-#else
-        int fd = open(file_path.c_str(), O_RDONLY);
-        if (fd == -1) {
-            return;
+    try {
+        // Use memory-mapped file for better performance
+        MappedFile mapped;
+        // Con il prefetch attivo la ricerca è uno streaming: ogni file esce
+        // dalla page cache appena letto e la finestra non la riempie
+        const MappedFile::Access access = m_prefetchDepth > 0 ? MappedFile::Access::Streaming
+                                        : m_physicalOrder     ? MappedFile::Access::Sequential
+                                                              : MappedFile::Access::Normal;
+        if (!mapped.open(path.data(), access)) {
+            return false;
         }
+        const char* file_data = mapped.data();
+        const size_t file_size = mapped.size();
 
-        struct stat sb;
-        if (fstat(fd, &sb) == -1) {
-            close(fd);
-            return;
+        scan_content(file_data, file_size, verdict);
+        hash = content_hash(file_data, file_size);
+
+        if (content_cache_.enabled()) {
+            content_cache_.insert(path, target.size, target.mtime, file_data, file_size, hash);
         }
-        file_size = static_cast<size_t>(sb.st_size);
+        return true;
+    } catch (const std::exception&) {
+        // Silently handle file read errors
+        return false;
+    }
+}
 
-        file_data = static_cast<const char*>(mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0));
-        if (file_data == MAP_FAILED) {
-            close(fd);
-            return;
+void SearchEngine::scan_content(const char* file_data, size_t file_size, ContentVerdict& verdict) const {
+    // Search in memory-mapped data (much faster than loading into string)
+    const MatchInfo info = scan_buffer(file_data, file_size);
+    verdict.count = info.count;
+    verdict.header_count = info.header_count;
+    verdict.edit_distance = info.edit_distance;
+}
+
+void SearchEngine::report_match(const ScannedFile& file,
+                                const ContentVerdict& verdict,
+                                const ResultCallback& result_cb) {
+    if (verdict.count == 0) {
+        return;
+    }
+
+    if (m_maxResults > 0) {
+        const size_t index = reported_.fetch_add(1);
+        if (index >= m_maxResults) {
+            return; // un altro worker è arrivato prima al limite
         }
-#endif
+        if (index + 1 == m_maxResults) {
+            stop_requested_ = true; // ferma anche chi è a metà di un file
+        }
+    }
 
-        if (file_size == 0 || file_data == nullptr) {
-#ifdef _WIN32
-            UnmapViewOfFile(file_data);
-            CloseHandle(hMapping);
-            CloseHandle(hFile);
-#else
-            munmap(const_cast<char*>(file_data), file_size);
-            close(fd);
-#endif
-            return;
+    // Unica copia del path sull'heap: quella che resta nel risultato
+    const std::filesystem::path file_path(file.path);
+    SearchResult result(file_path);
+    result.size         = file.size;
+    result.mtime        = unix_seconds(file.mtime);
+    result.root         = root_index(search_roots_, file_path);
+    result.match_count  = verdict.count;
+    result.header_match = verdict.header_count > 0;
+    result.name_match   = file_name_matches(file_path);
+    result.edit_distance = static_cast<uint32_t>(verdict.edit_distance);
+    result.score        = compute_score(file_path, m_literalLower, result);
+
+    {
+        std::scoped_lock<std::mutex> lock(results_mutex_);
+        if (m_retainResults) {
+            results_.push_back(result);
         }
+        if (recent_hits_.size() < HitHistory::kMaxHitsPerQuery) {
+            recent_hits_.push_back(file_path);
+        }
+    }
 
-        // Search in memory-mapped data (much faster than loading into string)
-        std::string_view file_content(file_data, file_size);
+    if (result_cb) {
+        result_cb(result);
+    }
+}
 
-        // Per file binari con match whole word, usa un approccio diverso
-        bool found = false;
+// Whole-word: i vicini del match non devono essere caratteri di identificatore
+static inline bool whole_word_ok(const char* data, size_t size, size_t match_pos, size_t match_len)
+{
+    const size_t end_pos = match_pos + match_len;
+    const bool valid_start = (match_pos == 0) || !is_identifier_char(data[match_pos - 1]);
+    const bool valid_end   = (end_pos >= size) || !is_identifier_char(data[end_pos]);
+    return valid_start && valid_end;
+}
 
-        // Cerca direttamente sui dati mmap (const char*) senza copiare il file.
-        const char* const data_begin = file_data;
-        const char* const data_end   = file_data + file_size;
+// Stesso controllo per un match UTF-16LE: i vicini sono code unit
+static inline bool whole_word_wide_ok(const char* data, size_t size, size_t match_pos, size_t match_len)
+{
+    const size_t end_pos = match_pos + match_len;
+    const bool valid_start = match_pos < 2 || data[match_pos - 1] != 0 || !is_identifier_char(data[match_pos - 2]);
+    const bool valid_end   = end_pos + 2 > size || data[end_pos + 1] != 0 || !is_identifier_char(data[end_pos]);
+    return valid_start && valid_end;
+}
 
-        // Carattere valido per un identificatore (per il controllo whole-word):
-        // lettere, numeri, underscore e trattino.
-        auto is_identifier_char = [](char c) -> bool {
-            return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '-';
-        };
+template <bool WholeWord, bool CaseSensitive>
+SearchEngine::MatchInfo SearchEngine::scan_literal(const char* data, size_t size) const
+{
+    // ---- FAST-PATH: substring, UTF-8 e UTF-16LE insieme ----
+    MatchInfo info;
+    size_t pos = 0;
+    scan_literal_range<WholeWord, CaseSensitive>(data, size, pos, size, uasset_header_size(data, size), info);
+    return info;
+}
 
-        if (m_isLiteral) {
-            // ---- FAST-PATH: ricerca substring case-insensitive sul buffer mmap ----
-            const std::string& needle = m_literalLower;
-            if (!needle.empty()) {
-                auto ci_eq = [](char a, char b) {
-                    // b (needle) è già minuscolo; confronta a minuscolo con b
-                    return std::tolower(static_cast<unsigned char>(a)) ==
-                           static_cast<unsigned char>(b);
-                };
-
-                const char* pos = data_begin;
-                while ((pos = std::search(pos, data_end,
-                                          needle.begin(), needle.end(), ci_eq)) != data_end) {
-                    if (!m_matchWholeWord) { found = true; break; }
-
-                    size_t match_pos = static_cast<size_t>(pos - data_begin);
-                    size_t end_pos   = match_pos + needle.size();
-                    bool valid_start = (match_pos == 0) ||
-                                       !is_identifier_char(file_content[match_pos - 1]);
-                    bool valid_end   = (end_pos >= file_content.length()) ||
-                                       !is_identifier_char(file_content[end_pos]);
-                    if (valid_start && valid_end) { found = true; break; }
-                    ++pos; // avanza per cercare l'occorrenza successiva
-                }
-            }
-        } else if (m_matchWholeWord) {
-            // ---- Regex con controllo whole-word, direttamente sul buffer mmap ----
-            std::cmatch match;
-            const char* search_start = data_begin;
-            while (std::regex_search(search_start, data_end, match, compiled_pattern_)) {
-                size_t match_pos = (search_start - data_begin) + match.position();
-                bool valid_start = (match_pos == 0) ||
-                                  !is_identifier_char(file_content[match_pos - 1]);
-                size_t end_pos = match_pos + match.length();
-                bool valid_end = (end_pos >= file_content.length()) ||
-                                !is_identifier_char(file_content[end_pos]);
-                if (valid_start && valid_end) { found = true; break; }
-                search_start = match.suffix().first;
+template <bool WholeWord, bool CaseSensitive>
+void SearchEngine::scan_literal_range(const char* data, size_t size, size_t& pos, size_t to,
+                                      size_t header_end, MatchInfo& info) const
+{
+    const std::string& needle = m_literalNeedle;
+    if (needle.empty()) {
+        pos = to;
+        return;
+    }
+
+    // A finestre: tra una e l'altra si controlla lo stop, così un limite
+    // raggiunto da un altro worker interrompe anche i file grandi.
+    // Un match che inizia nella finestra può sforarla di m_literalWide.size()
+    // byte; quelli che iniziano dopo sono della finestra successiva.
+    size_t window_end = 0;
+    while (pos < to) {
+        if (pos >= window_end) {
+            if (stop_requested_) break;
+            window_end = std::min(to, pos + kStopCheckBytes);
+        }
+        const size_t limit = std::min(size, window_end + m_literalWide.size());
+        const LiteralHit hit = find_literal<CaseSensitive>(data, limit, pos, needle, m_literalWide);
+        if (hit.pos == std::string::npos || hit.pos >= window_end) {
+            pos = window_end; // quelli oltre li ritrova la finestra dopo
+            continue;
+        }
+        if constexpr (WholeWord) {
+            const bool ok = hit.wide ? whole_word_wide_ok(data, size, hit.pos, hit.length)
+                                     : whole_word_ok(data, size, hit.pos, hit.length);
+            if (!ok) {
+                pos = hit.pos + 1; // avanza per cercare l'occorrenza successiva
+                continue;
             }
-        } else {
-            // ---- Regex semplice ----
-            found = std::regex_search(data_begin, data_end, compiled_pattern_);
         }
+        ++info.count;
+        if (hit.pos < header_end) ++info.header_count;
+        pos = hit.pos + hit.length;
+        if (info.count >= match_limit()) break;
+    }
+}
 
-        if (found) {
-            // For binary files, we'll just report "binary content" as the line
-            std::string content_preview = "Binary content match";
+template <bool WholeWord>
+SearchEngine::MatchInfo SearchEngine::scan_regex(const char* data, size_t size) const
+{
+    // ---- Regex, direttamente sul buffer mmap (il case è nei flag del pattern) ----
+    MatchInfo info;
+    const char* const data_end = data + size;
+    const size_t header_end = uasset_header_size(data, size);
+    std::cmatch match;
+    const char* search_start = data;
+    // Alle ripartenze il byte prima di search_start esiste: con
+    // match_prev_avail ^, \b e \B lo guardano invece di vedere un inizio
+    // del buffer a ogni match
+    auto flags = std::regex_constants::match_default;
+    while (search_start < data_end && !stop_requested_ &&
+           std::regex_search(search_start, data_end, match, compiled_pattern_, flags)) {
+        const size_t match_pos = (search_start - data) + match.position();
+        const size_t match_len = static_cast<size_t>(match.length());
+        if (!WholeWord || whole_word_ok(data, size, match_pos, match_len)) {
+            ++info.count;
+            if (match_pos < header_end) ++info.header_count;
+            if (info.count >= match_limit()) break;
+        }
+        // match vuoto (es. "a*"): avanza comunque di un byte
+        search_start = data + match_pos + std::max<size_t>(match_len, 1);
+        flags = std::regex_constants::match_prev_avail;
+    }
+    return info;
+}
 
-            // If it looks like text (no null bytes in first 1000 chars), show preview
-            size_t preview_size = std::min<size_t>(1000, file_content.length());
-            std::string_view preview = file_content.substr(0, preview_size);
+SearchEngine::MatchInfo SearchEngine::scan_approximate(const char* data, size_t size) const
+{
+    // ---- Approssimata: pezzi esatti come filtro, Myers sui dintorni ----
+    MatchInfo info;
+    info.edit_distance = m_approximate.max_edits();
+    const size_t header_end = uasset_header_size(data, size);
+    ApproximatePattern::Region pending;
+    std::vector<ApproximatePattern::Match> matches;
+    for (size_t pos = 0; pos < size && info.count < match_limit(); pos += kStopCheckBytes) {
+        if (stop_requested_) break;
+        matches.clear();
+        m_approximate.scan(data, size, pos, std::min(size, pos + kStopCheckBytes), pending, matches);
+        for (const auto& match : matches) {
+            ++info.count;
+            if (match.begin < header_end) ++info.header_count;
+            info.edit_distance = std::min(info.edit_distance, match.distance);
+            if (info.count >= match_limit()) break;
+        }
+    }
+    return info;
+}
 
-            bool is_likely_text = std::find(preview.begin(), preview.end(), '\0') == preview.end();
-            if (is_likely_text) {
-                std::string preview_str(preview);
-                // Replace newlines with spaces for single-line display
-                std::replace(preview_str.begin(), preview_str.end(), '\n', ' ');
-                std::replace(preview_str.begin(), preview_str.end(), '\r', ' ');
-                content_preview = std::move(preview_str);
-            }
+SearchEngine::MatchInfo SearchEngine::scan_query(const char* data, size_t size) const
+{
+    // ---- Query booleana: tutti i termini letterali nello stesso passaggio ----
+    MatchInfo info;
+    BooleanQuery::FileState state(m_query, uasset_header_size(data, size));
+    for (size_t pos = 0; pos < size && state.active != 0; pos += kStopCheckBytes) {
+        if (stop_requested_) return info;
+        m_query.scan(data, size, pos, std::min(size, pos + kStopCheckBytes), match_limit(), state);
+    }
+    if (!m_query.finish(data, size, match_limit(), state)) {
+        return info;
+    }
+    // parse() rifiuta le query vere senza termini: chi passa ne contiene almeno uno
+    info.count = state.count;
+    info.header_count = state.header_count;
+    return info;
+}
 
-            SearchResult result(file_path, content_preview, 1);
+SearchEngine::RangeKernel SearchEngine::select_range_kernel() const
+{
+    // Regex e query non hanno una lunghezza massima del match, la ricerca
+    // approssimata tiene stato tra le finestre: buffer intero
+    if (m_isQuery || !m_isLiteral || m_approximate.valid()) {
+        return nullptr;
+    }
+    if (m_matchWholeWord) {
+        return m_caseSensitive ? &SearchEngine::scan_literal_range<true, true>
+                               : &SearchEngine::scan_literal_range<true, false>;
+    }
+    return m_caseSensitive ? &SearchEngine::scan_literal_range<false, true>
+                           : &SearchEngine::scan_literal_range<false, false>;
+}
 
-            {
-                std::scoped_lock<std::mutex> lock(results_mutex_);
-                results_.push_back(result);
-            }
+SearchEngine::ScanKernel SearchEngine::select_scan_kernel() const
+{
+    if (m_isQuery) {
+        return &SearchEngine::scan_query;
+    }
+    if (m_isLiteral && m_approximate.valid()) {
+        return &SearchEngine::scan_approximate;
+    }
+    if (!m_isLiteral) {
+        return m_matchWholeWord ? &SearchEngine::scan_regex<true> : &SearchEngine::scan_regex<false>;
+    }
+    if (m_matchWholeWord) {
+        return m_caseSensitive ? &SearchEngine::scan_literal<true, true> : &SearchEngine::scan_literal<true, false>;
+    }
+    return m_caseSensitive ? &SearchEngine::scan_literal<false, true> : &SearchEngine::scan_literal<false, false>;
+}
 
-            if (result_cb) {
-                result_cb(result);
-            }
-        }
+bool SearchEngine::file_name_matches(const std::filesystem::path& file_path) const
+{
+    const std::string name = file_path.filename().string();
+    return name_matches(name, to_lower_copy(name));
+}
 
-        // Clean up memory mapping
-#ifdef _WIN32
-        UnmapViewOfFile(file_data);
-        CloseHandle(hMapping);
-        CloseHandle(hFile);
-#else
-        munmap(const_cast<char*>(file_data), file_size);
-        close(fd);
-#endif
-    } catch (const std::exception&) {
-        // Silently handle file read errors
+bool SearchEngine::name_matches(std::string_view name, std::string_view name_lower) const
+{
+    // Query: vale il primo termine non negato, con le stesse regole sul case
+    if (m_isQuery || m_isLiteral) {
+        if (m_literalNeedle.empty()) {
+            return false;
+        }
+        return m_caseSensitive ? name.find(m_literalNeedle) != std::string_view::npos
+                               : name_lower.find(m_literalLower) != std::string_view::npos;
     }
+    return std::regex_search(name.begin(), name.end(), compiled_pattern_);
 }
 
 void SearchEngine::search_directory_worker(const std::filesystem::path& dir_path,
@@ -302,65 +1064,624 @@ void SearchEngine::search_directory_worker(const std::filesystem::path& dir_path
     if (stop_requested_) {
         return;
     }
+    // Anche il walk è I/O: in background gira a priorità minima
+    std::optional<SearchQos::BackgroundThread> qos;
+    if (m_background) {
+        qos.emplace();
+    }
     try {
-        auto files = collect_files(dir_path);
-        size_t total_files = files.size();
-        size_t processed_files = 0;
+        // Con uno snapshot valido la scansione parte subito sulla lista salvata,
+        // mentre il walk vero gira in parallelo per validarla
+        std::filesystem::path snapshot_file;
+        FileTable files(dir_path);
+        std::future<FileTable> fresh_walk;
+        if (!snapshot_dir_.empty()) {
+            snapshot_file = FileSnapshot::file_for(snapshot_dir_, dir_path, walk_signature());
+            if (FileSnapshot::load(snapshot_file, dir_path, files)) {
+                fresh_walk = std::async(std::launch::async, [this, dir_path]() {
+                    std::optional<SearchQos::BackgroundThread> qos;
+                    if (m_background) {
+                        qos.emplace();
+                    }
+                    return collect_files(dir_path, true);
+                });
+            }
+        }
+        const bool from_snapshot = fresh_walk.valid();
+        if (!from_snapshot) {
+            files = collect_files(dir_path, true);
+        }
+
+        if (progress_cb) {
+            progress_cb("Searching in: " + dir_path.string(), 0, files.size());
+        }
+        std::pmr::vector<SnapshotRead> snapshot_reads(from_snapshot ? files.size() : 0, arena_.resource());
+        {
+            std::pmr::vector<const FileEntry*> all(arena_.resource());
+            all.reserve(files.size());
+            for (const FileEntry& file : files) {
+                all.push_back(&file);
+            }
+            scan_files(files, all, from_snapshot ? &snapshot_reads : nullptr, progress_cb, result_cb);
+        }
+
+        if (from_snapshot) {
+            // Patch: scansiona solo ciò che la scansione dallo snapshot non
+            // ha letto nello stato attuale
+            FileTable fresh = fresh_walk.get();
+            const std::pmr::vector<const FileEntry*> missed = snapshot_delta(files, snapshot_reads, fresh);
+            if (!missed.empty() && !stop_requested_) {
+                if (progress_cb) {
+                    progress_cb("Searching new files in: " + dir_path.string(), 0, missed.size());
+                }
+                scan_files(fresh, missed, nullptr, progress_cb, result_cb);
+            }
+            files = std::move(fresh);
+        }
+
+        add_to_path_index(files);
+        if (!snapshot_file.empty() && !stop_requested_) {
+            FileSnapshot::save(snapshot_file, dir_path, files);
+        }
+    } catch (const std::filesystem::filesystem_error& e) {
+        std::string error_msg = "Error accessing: " + dir_path.string() + " - " + e.what();
+        if (progress_cb) {
+            progress_cb(error_msg, 0, 0);
+        }
+    }
+}
+
+void SearchEngine::scan_files(const FileTable& table,
+                              const std::pmr::vector<const FileEntry*>& files,
+                              std::pmr::vector<SnapshotRead>* snapshot_reads,
+                              const ProgressCallback& progress_cb,
+                              const ResultCallback& result_cb) {
+    // Gli archivi .pak superano i limiti di size: si scandiscono le entry.
+    // I file fuori dai limiti non entrano nemmeno nel conteggio del progresso.
+    std::pmr::vector<const FileEntry*> regular(arena_.resource());
+    std::pmr::vector<const FileEntry*> paks(arena_.resource());
+    regular.reserve(files.size());
+    if (m_searchPaks) {
+        paks.reserve(std::count_if(files.begin(), files.end(), [&](const FileEntry* file) {
+            return PakFile::is_pak_name(narrow_name(table.name(*file)));
+        }));
+    }
+    uint64_t total_bytes = 0;
+    for (const FileEntry* file : files) {
+        if (m_searchPaks && PakFile::is_pak_name(narrow_name(table.name(*file)))) {
+            paks.push_back(file);
+        } else if (file->size >= min_file_size_ && file->size <= max_file_size_) {
+            regular.push_back(file);
+            total_bytes += file->size;
+        }
+    }
+    progress_.add_total(regular.size(), total_bytes);
+
+    auto scan_one = [&](const FileEntry* file) {
+        if (m_background) {
+            throttle_.before_file(file->size, stop_requested_);
+            if (stop_requested_) return;
+        }
+        // Il path esiste solo mentre il file viene letto, in un buffer del
+        // worker riusato da un file all'altro
+        thread_local FileTable::String path;
+        path.clear();
+        table.append_path(*file, path);
+        // Size e mtime dello snapshot possono essere vecchi: si rileggono
+        // prima di toccare le cache (contenuto, hash per il dedup), che
+        // altrimenti darebbero il verdetto di un file poi riscritto
+        FileEntry current = *file;
+        if (snapshot_reads != nullptr) {
+            SnapshotRead& read = (*snapshot_reads)[static_cast<size_t>(file - &table[0])];
+            read.read = true;
+            if (!stat_entry(path.c_str(), current)) {
+                read.size = UINT64_MAX; // se il walk lo trova, lo ripassa il delta
+                progress_.add_done(file->size);
+                return; // sparito dopo lo snapshot
+            }
+            read.size = current.size;
+            read.mtime = current.mtime;
+        }
+        search_file(current, ScannedFile{path, current.size, current.mtime}, result_cb);
+        progress_.add_done(file->size);
+    };
+
+    // Gli indici dei .pak si aprono in parallelo; le loro entry finiscono
+    // nella stessa lista di lavoro dei file normali
+    std::pmr::deque<PakScan> pak_scans(arena_.resource());
+    for (const FileEntry* pak : paks) {
+        PakScan& scan = pak_scans.emplace_back(arena_.resource());
+        scan.path = table.path(*pak);
+        scan.mtime = pak->mtime;
+        scan.device = pak->device;
+    }
+    parallel_for(pak_scans.size(), [&](size_t j) { open_pak(pak_scans[j], progress_cb); });
+    std::pmr::vector<std::pair<uint32_t, uint32_t>> pak_items(arena_.resource()); // (pak, entry)
+    size_t pak_entry_count = 0;
+    for (const PakScan& scan : pak_scans) {
+        pak_entry_count += scan.entries.size();
+    }
+    pak_items.reserve(pak_entry_count);
+    for (size_t p = 0; p < pak_scans.size(); ++p) {
+        for (size_t e = 0; e < pak_scans[p].entries.size(); ++e) {
+            pak_items.emplace_back(static_cast<uint32_t>(p), static_cast<uint32_t>(e));
+        }
+    }
 
+    if (m_physicalOrder) {
+        // Un gruppo per device, in parallelo tra loro, ognuno con pochi worker:
+        // più letture concorrenti sullo stesso disco a testine sono solo seek.
+        // Le root girano in parallelo (search): il tetto per device lo tiene
+        // device_slots_, comune a tutte.
+        sort_by_disk_order(table, regular);
+        std::vector<std::future<void>> devices;
+        for (size_t begin = 0; begin < regular.size();) {
+            size_t end = begin + 1;
+            while (end < regular.size() && regular[end]->device == regular[begin]->device) {
+                ++end;
+            }
+            devices.emplace_back(std::async(std::launch::async, [&, begin, end]() {
+                PrefetchWindow prefetch(table, regular.data() + begin, end - begin, m_prefetchDepth);
+                parallel_for(end - begin, [&](size_t j) {
+                    prefetch.advance(j);
+                    DiskLayout::DeviceSlots::Guard slot(device_slots_, regular[begin + j]->device);
+                    scan_one(regular[begin + j]);
+                }, m_deviceThreads);
+            }));
+            begin = end;
+        }
+        if (!pak_items.empty()) {
+            // Le entry sono già in ordine di offset (open_pak): un gruppo in
+            // più, sotto lo stesso tetto per device dei file normali
+            devices.emplace_back(std::async(std::launch::async, [&]() {
+                parallel_for(pak_items.size(), [&](size_t j) {
+                    const PakScan& pak = pak_scans[pak_items[j].first];
+                    DiskLayout::DeviceSlots::Guard slot(device_slots_, pak.device);
+                    scan_pak_entry(pak, pak_items[j].second, result_cb);
+                }, m_deviceThreads);
+            }));
+        }
+        for (auto const& device : devices) {
+            device.wait();
+        }
+    } else {
+        if (m_prioritizeLikely) {
+            sort_by_likelihood(table, regular);
+        }
+        PrefetchWindow prefetch(table, regular.data(), regular.size(), m_prefetchDepth);
+        parallel_for(regular.size() + pak_items.size(), [&](size_t j) {
+            if (j < regular.size()) {
+                prefetch.advance(j);
+                scan_one(regular[j]);
+            } else {
+                const auto& item = pak_items[j - regular.size()];
+                scan_pak_entry(pak_scans[item.first], item.second, result_cb);
+            }
+        });
+    }
+}
 
+void SearchEngine::open_pak(PakScan& pak, const ProgressCallback& progress_cb) {
+    if (stop_requested_) return;
+    if (!pak.archive.open(pak.path)) {
         if (progress_cb) {
-            progress_cb("Searching in: " + dir_path.string(), processed_files, total_files);
+            progress_cb("Cannot read pak index: " + pak.path.string(), 0, 0);
+        }
+        return;
+    }
+
+    // Le regole del walk valgono anche per le cartelle virtuali dell'archivio,
+    // sul path relativo alla cartella Content (pak_filter_start): è quello
+    // che hanno i file su disco quando la root è una cartella Content,
+    // qualunque sia il mount point dell'archivio ("../../../" o
+    // "../../../Game/Content/")
+    const PakFile& archive = pak.archive;
+    pak.entries.reserve(archive.entries().size());
+    std::string full; // riusato: nell'arena vanno solo i path accettati
+    uint64_t total_bytes = 0;
+    for (const auto& entry : archive.entries()) {
+        if (entry.uncompressed_size < min_file_size_ || entry.uncompressed_size > max_file_size_ ||
+            !archive.can_read(entry)) {
+            continue;
+        }
+        if (!file_filter_.empty()) {
+            full.assign(archive.mount_point()).append(entry.path);
+            const size_t start = pak_filter_start(full);
+            const std::string_view view(full);
+            bool pruned = false;
+            size_t begin = start;
+            for (size_t slash; !pruned && (slash = view.find('/', begin)) != std::string_view::npos; begin = slash + 1) {
+                pruned = file_filter_.prune_directory(view.substr(begin, slash - begin), view.substr(start, slash - start));
+            }
+            if (pruned || !file_filter_.accept_file(view.substr(begin), view.substr(start))) {
+                continue;
+            }
+        }
+        pak.entries.push_back(&entry);
+        total_bytes += entry.uncompressed_size;
+    }
+    if (m_physicalOrder) {
+        // In ordine di offset la lettura dell'archivio procede in avanti
+        std::sort(pak.entries.begin(), pak.entries.end(),
+                  [](const PakFile::Entry* a, const PakFile::Entry* b) { return a->offset < b->offset; });
+    }
+    pak.virtual_paths.reserve(pak.entries.size());
+    for (const PakFile::Entry* entry : pak.entries) {
+        std::pmr::string& virtual_path = pak.virtual_paths.emplace_back(archive.mount_point());
+        virtual_path.append(entry->path);
+    }
+    progress_.add_total(pak.entries.size(), total_bytes);
+
+    if (progress_cb) {
+        progress_cb("Searching in: " + pak.path.string(), 0, pak.entries.size());
+    }
+}
+
+void SearchEngine::scan_pak_entry(const PakScan& pak, size_t index, const ResultCallback& result_cb) {
+    const PakFile::Entry& entry = *pak.entries[index];
+    if (m_background) {
+        throttle_.before_file(entry.uncompressed_size, stop_requested_);
+    }
+    // Buffer di decompressione riusato dallo stesso thread
+    thread_local std::string buffer;
+    ContentVerdict verdict;
+    if (!stop_requested_ && scan_pak_content(pak.archive, entry, buffer, verdict)) {
+        ++stats_files_scanned_;
+        if (verdict.count > 0) {
+            const std::filesystem::path path = pak.path / std::filesystem::path(pak.virtual_paths[index]);
+            report_match(ScannedFile{path.native(), entry.uncompressed_size, pak.mtime}, verdict, result_cb);
         }
+    }
+    progress_.add_done(entry.uncompressed_size);
+}
 
-        // Process files in batches for better load balancing
-        const size_t batch_size = std::max(static_cast<size_t>(1), files.size() / thread_count_);
-        std::vector<std::future<void>> file_futures;
+bool SearchEngine::scan_pak_content(const PakFile& archive, const PakFile::Entry& entry,
+                                    std::string& buffer, ContentVerdict& verdict) const {
+    // Letterali su entry compresse a più blocchi: un blocco alla volta, con
+    // in testa gli ultimi byte del precedente per i match a cavallo. Un
+    // match inizia in [pos, to) di una sola finestra: quelli negli ultimi
+    // lookahead byte li conta la finestra dopo, che li ha per intero.
+    const size_t lookahead = std::max(m_literalNeedle.size(), m_literalWide.size()) + 2;
+    const size_t keep = lookahead + 2; // + i byte prima, per la parola intera
+    if (range_kernel_ != nullptr && archive.can_read_chunks(entry, keep)) {
+        MatchInfo info;
+        size_t header_end = 0;
+        uint64_t resume = 0; // offset nella entry da cui riprendere
+        const bool ok = archive.read_chunks(entry, keep, buffer,
+            [&](std::string_view window, uint64_t offset, bool last) {
+                if (offset == 0) {
+                    header_end = uasset_header_size(window.data(), window.size(), entry.uncompressed_size);
+                }
+                size_t pos = static_cast<size_t>(resume - offset);
+                const size_t to = last ? window.size() : window.size() - lookahead;
+                const size_t header = header_end > offset ? static_cast<size_t>(header_end - offset) : 0;
+                (this->*range_kernel_)(window.data(), window.size(), pos, to, header, info);
+                resume = offset + pos;
+                return info.count < match_limit() && !stop_requested_;
+            });
+        verdict.count = info.count;
+        verdict.header_count = info.header_count;
+        return ok;
+    }
+
+    std::string_view content;
+    if (!archive.read(entry, buffer, content)) {
+        return false;
+    }
+    scan_content(content.data(), content.size(), verdict);
+    return true;
+}
 
-        for (size_t i = 0; i < files.size() && !stop_requested_; i += batch_size) {
-            size_t end = std::min(i + batch_size, files.size());
+void SearchEngine::parallel_for(size_t count, const std::function<void(size_t)>& fn, size_t max_workers) {
+    // Blocchi piccoli presi in ordine da un contatore condiviso: i thread
+    // restano bilanciati e l'ordine della lista (es. prima i file probabili)
+    // è anche l'ordine in cui vengono scanditi
+    const size_t limit = max_workers > 0 ? std::min(max_workers, thread_count_) : thread_count_;
+    const size_t workers = std::max<size_t>(1, std::min(limit, count));
+    const size_t chunk = std::clamp<size_t>(count / (workers * 16), 1, 64);
+    std::atomic<size_t> next{0};
+    std::vector<std::future<void>> file_futures;
 
-            file_futures.emplace_back(
-                std::async(std::launch::async, [this, &files, i, end, result_cb, progress_cb, &processed_files, total_files]() {
+    for (size_t w = 0; w < workers && !stop_requested_; ++w) {
+        file_futures.emplace_back(
+            std::async(std::launch::async, [this, &fn, &next, chunk, count]() {
+                std::optional<SearchQos::BackgroundThread> qos;
+                if (m_background) {
+                    qos.emplace();
+                }
+                // Con i thread adattivi ogni blocco occupa uno dei posti del
+                // tuner, comuni a tutti i parallel_for in corso: chi non ne
+                // trova uno libero resta fermo qui finché il limite non sale,
+                // un altro blocco non finisce o la lista non si esaurisce
+                ConcurrencyTuner* const tuner = tuner_;
+                while (!stop_requested_) {
+                    if (tuner && !tuner->enter([&]() { return stop_requested_ || next.load() >= count; })) {
+                        break;
+                    }
+                    const size_t i = next.fetch_add(chunk);
+                    const size_t end = std::min(i + chunk, count);
                     for (size_t j = i; j < end && !stop_requested_; ++j) {
-                        search_file(files[j], result_cb);
-
-                        ++processed_files;
-                        if (progress_cb && (processed_files % 10 == 0 || processed_files == total_files)) {
-                            progress_cb("Processing files...", processed_files, total_files);
-                        }
+                        fn(j);
+                    }
+                    if (tuner) {
+                        tuner->leave();
+                    }
+                    if (i >= count) {
+                        break;
                     }
-                })
-            );
+                }
+                if (tuner) {
+                    tuner->wake(); // lista finita: i parcheggiati possono uscire
+                }
+            })
+        );
+    }
+
+    for (auto const& future : file_futures) {
+        future.wait();
+    }
+}
+
+void SearchEngine::sort_by_likelihood(const FileTable& table, std::pmr::vector<const FileEntry*>& files) {
+    // Punteggio calcolato una volta per file dai nomi della FileTable, senza
+    // ricostruire i path: le chiavi della storia partono da quella della
+    // cartella (una per directory) e solo se la storia ha qualcosa da dire.
+    // Il punteggio (un regex sul nome per i pattern regex) si calcola nel
+    // pool di worker, poi un sort sugli indici.
+    std::pmr::vector<uint64_t> dir_keys(arena_.resource());
+    if (scan_order_.uses_history()) {
+        dir_keys.reserve(table.directory_count());
+        FileTable::String directory;
+        for (uint32_t dir = 0; dir < table.directory_count(); ++dir) {
+            directory.clear();
+            table.append_directory(dir, directory);
+            dir_keys.push_back(HitHistory::directory_key(directory));
         }
+    }
 
-        for (auto const& future : file_futures) {
-            future.wait();
+    std::pmr::vector<std::pair<int, const FileEntry*>> keyed(files.size(), {0, nullptr}, arena_.resource());
+    parallel_for(files.size(), [&](size_t i) {
+        const FileEntry* file = files[i];
+        const FileTable::StringView native = table.name(*file);
+        const auto name = narrow_name(native);
+        thread_local std::string lower; // riusato dallo stesso thread
+        lower.assign(name);
+        std::transform(lower.begin(), lower.end(), lower.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        uint64_t dir_key = 0;
+        uint64_t file_key = 0;
+        if (!dir_keys.empty()) {
+            dir_key = dir_keys[file->dir];
+            file_key = HitHistory::file_key(dir_key, native);
         }
+        keyed[i] = {scan_order_.score(lower, dir_key, file_key, file->size, name_matches(name, lower)), file};
+    });
+    if (stop_requested_) {
+        return; // punteggi incompleti; la scansione non parte comunque
+    }
+    std::stable_sort(keyed.begin(), keyed.end(),
+                     [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (size_t i = 0; i < keyed.size(); ++i) {
+        files[i] = keyed[i].second;
+    }
+}
 
-    } catch (const std::filesystem::filesystem_error& e) {
-        std::string error_msg = "Error accessing: " + dir_path.string() + " - " + e.what();
-        if (progress_cb) {
-            progress_cb(error_msg, 0, 0);
+void SearchEngine::sort_by_disk_order(const FileTable& table, std::pmr::vector<const FileEntry*>& files) {
+    // Prima per inode: sui filesystem Unix gli inode vicini stanno vicini,
+    // e le query FIEMAP qui sotto leggono i metadati in quell'ordine
+    std::stable_sort(files.begin(), files.end(), [](const FileEntry* a, const FileEntry* b) {
+        return a->device != b->device ? a->device < b->device : a->inode < b->inode;
+    });
+
+    // Poi per extent fisico, quando il filesystem lo dice. I file senza
+    // (inline o fs che non risponde) vanno in testa nel loro ordine di inode.
+    // Una open + ioctl per file: nel pool di worker, con più richieste di
+    // metadati in coda il disco le serve in ordine invece che una per volta.
+    std::pmr::vector<std::pair<uint64_t, const FileEntry*>> keyed(files.size(), {0, nullptr}, arena_.resource());
+    std::atomic<bool> any_known{false};
+    parallel_for(files.size(), [&](size_t i) {
+        const uint64_t offset = DiskLayout::physical_offset(table.path(*files[i]));
+        if (offset != 0 && !any_known.load(std::memory_order_relaxed)) {
+            any_known = true;
+        }
+        keyed[i] = {offset, files[i]};
+    });
+    if (stop_requested_ || !any_known) {
+        return; // es. NFS/SMB: resta l'ordine di inode
+    }
+    std::stable_sort(keyed.begin(), keyed.end(), [](const auto& a, const auto& b) {
+        return a.second->device != b.second->device ? a.second->device < b.second->device : a.first < b.first;
+    });
+    for (size_t i = 0; i < keyed.size(); ++i) {
+        files[i] = keyed[i].second;
+    }
+}
+
+std::string SearchEngine::walk_signature() const {
+    return m_searchPaks ? file_filter_.signature() + "|pak" : file_filter_.signature();
+}
+
+// File del walk che la scansione dallo snapshot non ha letto nello stato
+// attuale: quelli nuovi, quelli mai letti (fuori dai limiti con la size
+// salvata, ora dentro) e quelli cambiati dopo la lettura. I limiti valgono
+// sulla size del walk. Un file cambiato durante la ricerca può così comparire
+// due volte: la seconda riga è quella col contenuto attuale.
+std::pmr::vector<const FileEntry*> SearchEngine::snapshot_delta(const FileTable& snapshot,
+                                                                const std::pmr::vector<SnapshotRead>& reads,
+                                                                const FileTable& fresh) {
+    // Le directory si abbinano per path relativo, una volta ciascuna; i file
+    // per (directory, nome), con il nome letto dal blob dello snapshot.
+    // I path relativi delle directory dello snapshot stanno nell'arena.
+    std::pmr::memory_resource* const arena = arena_.resource();
+    std::pmr::unordered_map<FileTable::StringView, uint32_t> snapshot_dirs(arena);
+    snapshot_dirs.reserve(snapshot.directory_count());
+    FileTable::String relative;
+    for (uint32_t dir = 0; dir < snapshot.directory_count(); ++dir) {
+        relative.clear();
+        snapshot.append_relative_directory(dir, relative);
+        auto* copy = static_cast<FileTable::Char*>(arena->allocate((relative.size() + 1) * sizeof(FileTable::Char),
+                                                                   alignof(FileTable::Char)));
+        std::copy(relative.begin(), relative.end(), copy);
+        snapshot_dirs.emplace(FileTable::StringView(copy, relative.size()), dir);
+    }
+    std::pmr::vector<uint32_t> fresh_to_snapshot(fresh.directory_count(), UINT32_MAX, arena);
+    for (uint32_t dir = 0; dir < fresh.directory_count(); ++dir) {
+        relative.clear();
+        fresh.append_relative_directory(dir, relative);
+        auto it = snapshot_dirs.find(FileTable::StringView(relative));
+        if (it != snapshot_dirs.end()) {
+            fresh_to_snapshot[dir] = it->second;
+        }
+    }
+
+    struct Key
+    {
+        uint32_t dir;
+        FileTable::StringView name;
+        bool operator==(const Key&) const = default;
+    };
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const
+        {
+            return std::hash<FileTable::StringView>{}(key.name) ^ (key.dir * 0x9E3779B97F4A7C15ull);
+        }
+    };
+    std::pmr::unordered_map<Key, size_t, KeyHash> known(arena);
+    known.reserve(snapshot.size());
+    for (size_t i = 0; i < snapshot.size(); ++i) {
+        known.emplace(Key{snapshot[i].dir, snapshot.name(snapshot[i])}, i);
+    }
+
+    auto in_limits = [this](uint64_t size) { return size >= min_file_size_ && size <= max_file_size_; };
+
+    std::pmr::vector<const FileEntry*> missed(arena);
+    missed.reserve(fresh.size()); // un puntatore per file, come la lista completa
+    for (const FileEntry& entry : fresh) {
+        const uint32_t dir = fresh_to_snapshot[entry.dir];
+        auto it = dir == UINT32_MAX ? known.end() : known.find(Key{dir, fresh.name(entry)});
+        if (it == known.end()) {
+            missed.push_back(&entry);
+            continue;
+        }
+        // I .pak li ha già riaperti scan_files, qualunque size avessero
+        if ((m_searchPaks && PakFile::is_pak_name(narrow_name(fresh.name(entry)))) || !in_limits(entry.size)) {
+            continue;
+        }
+        const SnapshotRead& read = reads[it->second];
+        if (!read.read || read.size != entry.size || read.mtime != entry.mtime) {
+            missed.push_back(&entry);
+        }
+    }
+    return missed;
+}
+
+void SearchEngine::preload_snapshots(const std::vector<std::filesystem::path>& search_paths) {
+    if (snapshot_dir_.empty() || searching_) {
+        return;
+    }
+
+    std::vector<FileTable> tables;
+    for (const auto& root : search_paths) {
+        FileTable& files = tables.emplace_back(root);
+        if (!FileSnapshot::load(FileSnapshot::file_for(snapshot_dir_, root, walk_signature()), root, files)) {
+            return; // indice parziale inutile: lo costruirà la prima ricerca
         }
     }
+
+    {
+        std::scoped_lock<std::mutex> lock(path_index_mutex_);
+        path_index_.clear();
+        path_index_roots_ = search_paths;
+        path_index_filter_ = walk_signature();
+    }
+    for (const FileTable& files : tables) {
+        add_to_path_index(files);
+    }
+    std::scoped_lock<std::mutex> lock(path_index_mutex_);
+    path_index_complete_ = true;
 }
 
-std::vector<std::filesystem::path> SearchEngine::collect_files(const std::filesystem::path& directory) const {
-    std::vector<std::filesystem::path> files;
-    size_t directory_count = 0;
-    size_t file_count = 0;
+std::filesystem::path SearchEngine::default_snapshot_dir() {
+    return private_temp_dir();
+}
+
+FileTable SearchEngine::collect_files(const std::filesystem::path& directory, bool with_sizes) const {
+    FileTable files(directory);
+    const FileFilter& filter = file_filter_;
+
+    // Path relativo alla root, solo se qualche regola lo richiede
+    size_t root_len = directory.native().size();
+    if (root_len > 0 && directory.native().back() != std::filesystem::path::preferred_separator &&
+        directory.native().back() != '/') {
+        ++root_len;
+    }
+#ifdef _WIN32
+    // Nome e path relativo convertiti dal path UTF-16
+    auto name_of = [](const std::filesystem::path& p) { return p.filename().string(); };
+    auto native_name_of = [](const std::filesystem::path& p) { return p.filename().native(); };
+    auto relative_of = [&](const std::filesystem::path& p) -> std::string {
+        if (!filter.needs_relative_path() || p.native().size() <= root_len) return {};
+        return std::filesystem::path(p.native().substr(root_len)).generic_string();
+    };
+#else
+    // POSIX: viste sul path nativo, nessuna stringa allocata per file
+    auto name_of = [](const std::filesystem::path& p) {
+        const std::string_view native = p.native();
+        return native.substr(native.rfind('/') + 1);
+    };
+    auto native_name_of = name_of;
+    auto relative_of = [&](const std::filesystem::path& p) -> std::string_view {
+        if (!filter.needs_relative_path() || p.native().size() <= root_len) return {};
+        return std::string_view(p.native()).substr(root_len);
+    };
+#endif
+
+    // Directory della tabella per profondità: il walk è in pre-ordine, il
+    // padre di una voce a profondità d è l'ultima directory vista a d - 1
+    std::vector<uint32_t> parents{FileTable::kRoot};
 
     try {
-        for (const auto& entry : std::filesystem::recursive_directory_iterator(directory)) {
+        auto options = std::filesystem::directory_options::skip_permission_denied;
+        for (auto it = std::filesystem::recursive_directory_iterator(directory, options);
+             it != std::filesystem::recursive_directory_iterator(); ++it) {
             if (stop_requested_) {
                 break;
             }
 
+            const auto& entry = *it;
+            const size_t depth = static_cast<size_t>(it.depth());
+            parents.resize(depth + 1);
+            // is_directory/is_regular_file usano il tipo letto da readdir:
+            // nessuno stat per i file che le regole scartano
             if (entry.is_directory()) {
-                directory_count++;
+                if (!filter.empty() &&
+                    filter.prune_directory(name_of(entry.path()), relative_of(entry.path()))) {
+                    it.disable_recursion_pending(); // l'intero sottoalbero non viene visitato
+                } else {
+                    parents.push_back(files.add_directory(parents[depth], native_name_of(entry.path())));
+                }
             } else if (entry.is_regular_file()) {
-                files.push_back(entry.path());
-                file_count++;
+                const auto name = name_of(entry.path());
+                const bool is_pak = m_searchPaks && PakFile::is_pak_name(name);
+                if (!filter.empty() && !is_pak && !filter.accept_file(name, relative_of(entry.path()))) {
+                    continue;
+                }
+
+                FileEntry& file = files.add_file(parents[depth], native_name_of(entry.path()));
+                if (with_sizes) {
+#ifdef _WIN32
+                    // Su Windows size e data arrivano già da FindNextFile
+                    std::error_code ec;
+                    file.size = entry.file_size(ec);
+                    if (ec) file.size = UINT64_MAX; // fuori da qualsiasi limite
+                    file.mtime = entry.last_write_time(ec).time_since_epoch().count();
+#else
+                    if (!stat_entry(entry.path().c_str(), file)) {
+                        file.size = UINT64_MAX; // fuori da qualsiasi limite
+                    }
+#endif
+                }
             }
         }
     } catch (const std::filesystem::filesystem_error&) {
@@ -368,4 +1689,138 @@ std::vector<std::filesystem::path> SearchEngine::collect_files(const std::filesy
     }
 
     return files;
+}
+
+std::vector<std::filesystem::path> SearchEngine::default_search_paths(bool include_plugins) {
+    std::vector<std::filesystem::path> search_paths;
+
+    // Default Content/Assets path
+    if (std::filesystem::exists("Content/Assets")) {
+        search_paths.push_back(std::filesystem::path("Content/Assets"));
+    }
+
+    // Add plugin paths if enabled
+    if (include_plugins) {
+        try {
+            if (std::filesystem::exists("Plugins")) {
+                for (const auto& plugin_dir : std::filesystem::directory_iterator("Plugins")) {
+                    if (plugin_dir.is_directory()) {
+                        auto content_path = plugin_dir.path() / "Content";
+                        if (std::filesystem::exists(content_path)) {
+                            search_paths.push_back(content_path);
+                        }
+                    }
+                }
+            }
+        } catch (const std::filesystem::filesystem_error&) {
+            // Skip if can't access Plugins directory
+        }
+    }
+
+    return search_paths;
+}
+
+void SearchEngine::search_names(const std::string& search_pattern,
+                                const std::vector<std::filesystem::path>& search_paths,
+                                const ProgressCallback& progress_cb,
+                                const ResultCallback& result_cb) {
+    if (!path_index_covers(search_paths)) {
+        if (progress_cb) {
+            progress_cb("Indexing file names...", 0, 0);
+        }
+        {
+            std::scoped_lock<std::mutex> lock(path_index_mutex_);
+            path_index_.clear();
+            path_index_roots_ = search_paths;
+            path_index_filter_ = walk_signature();
+            path_index_complete_ = false;
+        }
+
+        std::vector<std::future<void>> futures;
+        for (const auto& path : search_paths) {
+            if (stop_requested_) break;
+
+            if (std::filesystem::exists(path)) {
+                futures.emplace_back(std::async(std::launch::async, [this, path]() {
+                    add_to_path_index(collect_files(path, false));
+                }));
+            } else if (progress_cb) {
+                progress_cb("Directory not found: " + path.string(), 0, 0);
+            }
+        }
+        for (const auto& future : futures) {
+            future.wait();
+        }
+
+        if (stop_requested_) {
+            return;
+        }
+        std::scoped_lock<std::mutex> lock(path_index_mutex_);
+        path_index_complete_ = true;
+    }
+
+    std::vector<SearchResult> found;
+    {
+        std::scoped_lock<std::mutex> lock(path_index_mutex_);
+        found = query_path_index(search_pattern, m_maxResults);
+    }
+    {
+        std::scoped_lock<std::mutex> lock(results_mutex_);
+        results_.insert(results_.end(), found.begin(), found.end());
+    }
+    if (result_cb) {
+        for (const auto& result : found) {
+            result_cb(result);
+        }
+    }
+}
+
+bool SearchEngine::query_names(const std::string& pattern,
+                               const std::vector<std::filesystem::path>& search_paths,
+                               size_t limit,
+                               std::vector<SearchResult>& out) const {
+    std::scoped_lock<std::mutex> lock(path_index_mutex_);
+    if (!path_index_complete_ || path_index_roots_ != search_paths ||
+        path_index_filter_ != walk_signature()) {
+        return false;
+    }
+    out = query_path_index(pattern, limit);
+    return true;
+}
+
+void SearchEngine::add_to_path_index(const FileTable& files) {
+    // Il path di ogni directory si ricostruisce una volta sola
+    std::vector<uint32_t> index_dir(files.directory_count(), UINT32_MAX);
+    std::scoped_lock<std::mutex> lock(path_index_mutex_);
+    path_index_.reserve(files.size());
+    for (const FileEntry& file : files) {
+        uint32_t& dir = index_dir[file.dir];
+        if (dir == UINT32_MAX) {
+            dir = path_index_.add_directory(files.directory_path(file.dir));
+        }
+        path_index_.add(dir, narrow_name(files.name(file)));
+    }
+}
+
+bool SearchEngine::path_index_covers(const std::vector<std::filesystem::path>& search_paths) const {
+    std::scoped_lock<std::mutex> lock(path_index_mutex_);
+    return path_index_complete_ && path_index_roots_ == search_paths &&
+           path_index_filter_ == walk_signature();
+}
+
+// Chiamante: path_index_mutex_ già acquisito
+std::vector<SearchResult> SearchEngine::query_path_index(const std::string& pattern, size_t limit) const {
+    // Per il punteggio conta solo un pattern senza wildcard (match esatto del nome)
+    const bool is_glob = pattern.find_first_of("*?") != std::string::npos;
+    const std::string literal_lower = is_glob ? std::string() : to_lower_copy(pattern);
+
+    std::vector<SearchResult> found;
+    for (uint32_t id : path_index_.query(pattern, limit)) {
+        SearchResult result(path_index_.path(id));
+        result.root = root_index(path_index_roots_, result.file_path);
+        result.name_match = true;
+        result.score = compute_score(result.file_path, literal_lower, result);
+        found.push_back(std::move(result));
+    }
+    return found;
 }
\ No newline at end of file
@@ -1,5 +1,21 @@
 #pragma once
 
+#include "ApproximateMatch.h"
+#include "BooleanQuery.h"
+#include "ConcurrencyTuner.h"
+#include "ContentCache.h"
+#include "ContentDedup.h"
+#include "DiskLayout.h"
+#include "FileFilter.h"
+#include "FileTable.h"
+#include "Generator.h"
+#include "PakFile.h"
+#include "PathIndex.h"
+#include "ScanOrder.h"
+#include "SearchArena.h"
+#include "SearchQos.h"
+#include "SearchProgress.h"
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <future>
@@ -8,20 +24,70 @@
 #include <regex>
 #include <mutex>
 #include <atomic>
+#include <cstdint>
 
 struct SearchResult
 {
     std::filesystem::path file_path;
-    std::string line_content;
-    size_t line_number;
+    uint64_t size = 0;  // byte; per una entry di .pak la dimensione decompressa
+    int64_t  mtime = 0; // secondi Unix; 0 = non noto (ricerca sui soli nomi)
+    uint32_t root = 0;  // indice della root in SearchRequest::paths
 
-    SearchResult(const std::filesystem::path &path, const std::string &content, size_t line_num)
-        : file_path(path), line_content(content), line_number(line_num) {}
+    // Ranking: calcolato durante la scansione, più alto = più rilevante
+    size_t match_count = 0;   // occorrenze trovate (saturato a SearchEngine::kMaxCountedMatches)
+    bool   header_match = false; // almeno un match nell'header (name table / import)
+    bool   name_match = false;   // il nome del file contiene il pattern
+    uint32_t edit_distance = 0;  // ricerca approssimata: errori dell'occorrenza migliore
+    int    score = 0;
+
+    SearchResult() = default;
+    explicit SearchResult(std::filesystem::path path) : file_path(std::move(path)) {}
+};
+
+// Una ricerca completa di opzioni, come la costruiscono GUI e CLI e come
+// viaggia verso il daemon (vedi SearchDaemon)
+struct SearchRequest
+{
+    std::string pattern;
+    std::vector<std::filesystem::path> paths;
+    std::string include;
+    std::string exclude = FileFilter::kDefaultExclude;
+    std::string extensions = FileFilter::kDefaultExtensions;
+    uint64_t min_file_size = 100;
+    uint64_t max_file_size = 1024 * 1024;
+    bool whole_word = false;
+    bool case_sensitive = false;
+    size_t max_edits = 0;           // errori ammessi nel contenuto (0 = ricerca esatta)
+    bool names_only = false;
+    bool search_paks = false;
+    size_t max_results = 0;         // 0 = tutti; altrimenti si ferma al risultato N
+    bool prioritize_likely = true;  // scandisce prima i file più promettenti (vedi ScanOrder)
+    bool physical_order = false;    // HDD/rete: ordine fisico sul disco, prevale su prioritize_likely
+    size_t device_threads = 2;      // con physical_order: worker massimi per device
+    size_t prefetch_depth = 0;      // file chiesti in anticipo al kernel (0 = nessun prefetch)
+    bool adaptive_threads = false;  // worker attivi regolati sul throughput misurato
+    bool background = false;        // priorità minime, in pausa quando il sistema è occupato
+    uint64_t background_bandwidth = 0; // con background: byte/s massimi letti (0 = senza tetto)
+    bool count_matches = true;      // false: un match per file basta (nessuno mostra i conteggi)
+};
+
+// Contatori dell'ultima ricerca (o di quella in corso)
+struct SearchStats
+{
+    size_t files_scanned = 0;      // file aperti e scanditi
+    size_t files_deduplicated = 0; // copie che hanno riusato il verdetto di un'altra
+    size_t cache_hits = 0;         // file letti dalla ContentCache
+    size_t cache_misses = 0;       // file letti da disco con la cache attiva
+    size_t cache_bytes = 0;        // occupazione attuale della cache
 };
 
 class SearchEngine
 {
 public:
+    // Oltre questa soglia le occorrenze non vengono più contate: il punteggio
+    // satura comunque e non vale la pena scandire il resto del file.
+    static constexpr size_t kMaxCountedMatches = 64;
+
     using ProgressCallback = std::function<void(const std::string &, size_t, size_t)>;
     using ResultCallback = std::function<void(const SearchResult &)>;
 
@@ -34,15 +100,37 @@ public:
         max_file_size_ = max_size;
     }
 
+    // search_pattern: testo letterale, regex o query booleana sul contenuto
+    // ("Damage AND Shield AND NOT Deprecated", vedi BooleanQuery)
     void search(const std::string &search_pattern,
                 const std::vector<std::filesystem::path> &search_paths,
                 const ProgressCallback& progress_cb = nullptr,
                 const ResultCallback& result_cb = nullptr);
 
+    // Applica le opzioni della richiesta e cerca
+    void search(const SearchRequest &request,
+                const ProgressCallback& progress_cb = nullptr,
+                const ResultCallback& result_cb = nullptr);
+
+    // Risultati a richiesta, a batch di batch_size: la ricerca gira in un
+    // thread proprio e riempie una coda di al più capacity risultati; a coda
+    // piena i worker si fermano finché il consumatore non chiede il batch
+    // successivo. Distruggere il generatore a metà interrompe la ricerca.
+    // I risultati non vengono accumulati in get_results().
+    Generator<std::vector<SearchResult>> stream(SearchRequest request,
+                                                size_t batch_size = 100,
+                                                size_t capacity = 1000,
+                                                ProgressCallback progress_cb = nullptr);
+
     void stop_search();
     bool is_searching() const { return searching_; }
 
     const std::vector<SearchResult> &get_results() const { return results_; }
+    SearchStats get_stats() const;
+
+    // File e byte scanditi, velocità ed ETA della ricerca in corso (o
+    // dell'ultima). Economico: si può chiamare a ogni frame.
+    SearchProgress::Snapshot get_progress() const { return progress_.snapshot(); }
     void clear_results();
 
     void set_thread_count(size_t threads) { thread_count_ = threads; }
@@ -50,18 +138,215 @@ public:
 
     void set_match_whole_word(bool match) { m_matchWholeWord = match; }
 
+    // Maiuscole/minuscole distinte nel contenuto e nel confronto col nome
+    // del file. La ricerca per soli nomi (indice dei path) resta insensibile.
+    void set_case_sensitive(bool sensitive) { m_caseSensitive = sensitive; }
+
+    // Ricerca approssimata: il pattern letterale combacia anche con fino a
+    // max_edits errori (lettere mancanti, in più o sbagliate), vedi
+    // ApproximatePattern. Non vale per regex, whole-word e forma UTF-16;
+    // ridotto sui pattern corti, che con troppi errori combacerebbero ovunque.
+    // 0 = ricerca esatta.
+    void set_max_edits(size_t max_edits) { m_maxEdits = max_edits; }
+
+    // Limite ai risultati: raggiunto l'N-esimo, tutti i worker si fermano,
+    // anche a metà di un file. 1 = "il nome è usato da qualche parte?".
+    // 0 = nessun limite.
+    void set_max_results(size_t max_results) { m_maxResults = max_results; }
+
+    // Conta le occorrenze fino a kMaxCountedMatches (colonna Matches e
+    // ranking); false = per ogni file basta il primo match, che con le
+    // regex risparmia una regex_search per occorrenza.
+    void set_count_matches(bool count) { m_countMatches = count; }
+
+    // Ordina la scansione per probabilità di match (ScanOrder: nome simile al
+    // pattern, hit di query simili, file piccoli prima) invece che per ordine
+    // di walk: i primi risultati arrivano subito, il totale non cambia.
+    void set_prioritize_likely(bool prioritize) { m_prioritizeLikely = prioritize; }
+
+    // Per dischi a testine e share di rete, dove la scansione è dominata dai
+    // seek: i file si leggono nell'ordine in cui stanno sul disco (inode,
+    // poi extent fisico, vedi DiskLayout), con al più device_threads letture
+    // concorrenti per device, contate su tutte le root della ricerca, e
+    // readahead sequenziale. Prevale su set_prioritize_likely.
+    void set_physical_order(bool physical, size_t device_threads = 2)
+    {
+        m_physicalOrder = physical;
+        m_deviceThreads = std::max<size_t>(1, device_threads);
+    }
+
+    // Prefetch: mentre si scandisce il file j, i file fino a j + depth
+    // vengono chiesti al kernel (POSIX_FADV_WILLNEED) e ogni file letto esce
+    // dalla page cache (DONTNEED). Tiene il disco occupato su scansioni
+    // lunghe senza buttare fuori dalla cache il resto del sistema; le
+    // ricerche ripetute però rileggono da disco. 0 = disattivato.
+    void set_prefetch_depth(size_t depth) { m_prefetchDepth = depth; }
+
+    // Thread adattivi: get_thread_count() diventa il massimo, i worker attivi
+    // li sceglie un ConcurrencyTuner misurando il throughput durante la
+    // ricerca. Il valore migliore viene ricordato per il volume della prima
+    // root (e salvato nella directory degli snapshot, se impostata) e la
+    // ricerca successiva parte da lì.
+    void set_adaptive_threads(bool adaptive) { m_adaptiveThreads = adaptive; }
+
+    // Ricerca in background (vedi SearchQos): walk e worker girano con
+    // priorità CPU e I/O minime, leggono al più bytes_per_second (0 = senza
+    // tetto) e si fermano tra un file e l'altro quando altri processi tengono
+    // la CPU occupata o quando parte una ricerca in primo piano nello stesso
+    // processo. Le ricerche normali sono in primo piano.
+    void set_background(bool background, uint64_t bytes_per_second = 0)
+    {
+        m_background = background;
+        m_backgroundBandwidth = bytes_per_second;
+    }
+
+    // Cerca anche dentro gli archivi .pak (build cooked): ogni entry è un file
+    // virtuale "Archivio.pak/Game/Content/...", filtrato con le stesse regole.
+    // I glob con '/' vedono il path dopo la cartella Content ("Weapons/..."),
+    // come un file su disco cercato con root .../Content.
+    void set_search_paks(bool search_paks) { m_searchPaks = search_paks; }
+
+    // Regole include/exclude/estensioni, applicate durante il walk
+    void set_file_filter(FileFilter filter) { file_filter_ = std::move(filter); }
+    const FileFilter &get_file_filter() const { return file_filter_; }
+
+    // Snapshot della lista file (vedi FileSnapshot): la prima ricerca dopo
+    // l'avvio parte dalla lista salvata invece che da un walk a freddo.
+    // Directory vuota = disabilitato.
+    void set_snapshot_dir(const std::filesystem::path &dir) { snapshot_dir_ = dir; }
+    // Directory privata dell'utente (vedi private_temp_dir)
+    static std::filesystem::path default_snapshot_dir();
+
+    // Carica gli snapshot di search_paths nell'indice dei nomi, così il
+    // type-ahead funziona subito all'avvio
+    void preload_snapshots(const std::vector<std::filesystem::path> &search_paths);
+
+    // Cache in memoria dei file scanditi, tra una ricerca e l'altra.
+    // Utile su dischi lenti/di rete con query ripetute. 0 = disabilitata.
+    void set_content_cache_budget(size_t bytes) { content_cache_.set_budget(bytes); }
+    size_t get_content_cache_budget() const { return content_cache_.budget(); }
+
+    // Root di default di un progetto Unreal: Content/Assets e, se richiesto,
+    // Plugins/*/Content (relative alla working directory)
+    static std::vector<std::filesystem::path> default_search_paths(bool include_plugins);
+
+    // Modalità "solo nome file": search() interroga l'indice dei path invece
+    // di aprire i file. Il pattern è una substring o un glob ('*', '?').
+    void set_names_only(bool names_only) { m_namesOnly = names_only; }
+
+    // Type-ahead: query sincrona sull'indice in memoria, senza toccare il disco.
+    // Ritorna false se l'indice non copre (ancora) search_paths.
+    bool query_names(const std::string &pattern,
+                     const std::vector<std::filesystem::path> &search_paths,
+                     size_t limit,
+                     std::vector<SearchResult> &out) const;
+
 private:
-    void search_file(const std::filesystem::path &file_path,
+    struct MatchInfo
+    {
+        size_t count = 0;        // occorrenze valide (max match_limit())
+        size_t header_count = 0; // di cui dentro l'header del package
+        size_t edit_distance = 0; // ricerca approssimata: la migliore tra le occorrenze
+    };
+
+    size_t match_limit() const { return m_countMatches ? kMaxCountedMatches : 1; }
+
+    MatchInfo scan_buffer(const char *data, size_t size) const { return (this->*scan_kernel_)(data, size); }
+
+    // Kernel letterali su una parte del buffer, per chi lo riceve a pezzi
+    // (entry compresse dei .pak): conta i match che iniziano in [pos, to)
+    // guardando anche i byte intorno, e lascia in pos dove riprendere
+    using RangeKernel = void (SearchEngine::*)(const char *data, size_t size, size_t &pos, size_t to,
+                                               size_t header_end, MatchInfo &info) const;
+    template <bool WholeWord, bool CaseSensitive>
+    void scan_literal_range(const char *data, size_t size, size_t &pos, size_t to,
+                            size_t header_end, MatchInfo &info) const;
+    RangeKernel select_range_kernel() const;
+
+    // Kernel di scansione, uno per combinazione di opzioni: scelto una volta
+    // per ricerca (select_scan_kernel), nel ciclo sui byte non restano if
+    // sulle opzioni
+    using ScanKernel = MatchInfo (SearchEngine::*)(const char *data, size_t size) const;
+    template <bool WholeWord, bool CaseSensitive>
+    MatchInfo scan_literal(const char *data, size_t size) const;
+    template <bool WholeWord>
+    MatchInfo scan_regex(const char *data, size_t size) const;
+    MatchInfo scan_approximate(const char *data, size_t size) const;
+    MatchInfo scan_query(const char *data, size_t size) const;
+    ScanKernel select_scan_kernel() const;
+    bool file_name_matches(const std::filesystem::path &file_path) const;
+    // Nome già estratto; name_lower: lo stesso in minuscolo
+    bool name_matches(std::string_view name, std::string_view name_lower) const;
+
+    void search_file(const FileEntry &file, const ScannedFile &target,
                      const ResultCallback& result_cb);
+    bool scan_file(const ScannedFile &target, ContentVerdict &verdict, uint64_t &hash);
+    void scan_content(const char *data, size_t size, ContentVerdict &verdict) const;
+    void report_match(const ScannedFile &file,
+                      const ContentVerdict &verdict,
+                      const ResultCallback& result_cb);
 
     void search_directory_worker(const std::filesystem::path &dir_path,
                                  const ProgressCallback& progress_cb,
                                  const ResultCallback& result_cb);
 
-    std::vector<std::filesystem::path> collect_files(const std::filesystem::path &directory) const;
+    // Size e mtime con cui la scansione dallo snapshot ha letto un file
+    // (per indice nella tabella); snapshot_delta li confronta col walk vero
+    struct SnapshotRead
+    {
+        uint64_t size = 0;
+        int64_t  mtime = 0;
+        bool read = false;
+    };
+
+    // snapshot_reads != nullptr: la tabella viene da uno snapshot, size e
+    // mtime vanno riletti prima dell'uso e registrati lì
+    void scan_files(const FileTable &table,
+                    const std::pmr::vector<const FileEntry *> &files,
+                    std::pmr::vector<SnapshotRead> *snapshot_reads,
+                    const ProgressCallback& progress_cb,
+                    const ResultCallback& result_cb);
+
+    // Un archivio .pak da scandire: indice aperto ed entry che passano i
+    // filtri, scandite dagli stessi worker dei file normali
+    struct PakScan
+    {
+        explicit PakScan(std::pmr::memory_resource *resource) : entries(resource), virtual_paths(resource) {}
+
+        PakFile archive;
+        std::filesystem::path path;
+        int64_t mtime = 0;
+        uint64_t device = 0;
+        std::pmr::vector<const PakFile::Entry *> entries;
+        std::pmr::vector<std::pmr::string> virtual_paths; // mount point + path, per indice in entries
+    };
+    void open_pak(PakScan &pak, const ProgressCallback& progress_cb);
+    void scan_pak_entry(const PakScan &pak, size_t index, const ResultCallback& result_cb);
+    bool scan_pak_content(const PakFile &archive, const PakFile::Entry &entry,
+                          std::string &buffer, ContentVerdict &verdict) const;
+    void parallel_for(size_t count, const std::function<void(size_t)> &fn, size_t max_workers = 0);
+    void sort_by_likelihood(const FileTable &table, std::pmr::vector<const FileEntry *> &files);
+    void sort_by_disk_order(const FileTable &table, std::pmr::vector<const FileEntry *> &files);
+
+    // Firma di tutto ciò che decide quali file raccoglie il walk
+    std::string walk_signature() const;
+
+    FileTable collect_files(const std::filesystem::path &directory, bool with_sizes) const;
+    std::pmr::vector<const FileEntry *> snapshot_delta(const FileTable &snapshot,
+                                                       const std::pmr::vector<SnapshotRead> &reads,
+                                                       const FileTable &fresh);
+
+    void search_names(const std::string &search_pattern,
+                      const std::vector<std::filesystem::path> &search_paths,
+                      const ProgressCallback &progress_cb,
+                      const ResultCallback &result_cb);
+    void add_to_path_index(const FileTable &files);
+    bool path_index_covers(const std::vector<std::filesystem::path> &search_paths) const;
+    std::vector<SearchResult> query_path_index(const std::string &pattern, size_t limit) const;
 
     mutable std::mutex results_mutex_;
     std::vector<SearchResult> results_;
+    std::vector<std::filesystem::path> recent_hits_; // per hit_history_, sotto results_mutex_
     std::atomic<bool> searching_{false};
     std::atomic<bool> stop_requested_{false};
     size_t thread_count_;
@@ -71,9 +356,66 @@ private:
 
     std::regex compiled_pattern_; // Cached compiled regex (solo per pattern non letterali)
     bool m_matchWholeWord = false;
+    bool m_caseSensitive = false;
+    size_t m_maxEdits = 0;
+    ScanKernel scan_kernel_ = nullptr; // della ricerca corrente
+    RangeKernel range_kernel_ = nullptr; // nullptr: il kernel vuole il buffer intero
+    size_t m_maxResults = 0;
+    bool m_countMatches = true;
+    bool m_prioritizeLikely = true;
+    bool m_physicalOrder = false;
+    size_t m_deviceThreads = 2;
+    size_t m_prefetchDepth = 0;
+    bool m_adaptiveThreads = false;
+    bool m_background = false;
+    uint64_t m_backgroundBandwidth = 0;
+    SearchQos::Throttle throttle_; // della ricerca corrente, se in background
+    DiskLayout::DeviceSlots device_slots_; // lettori per device, per tutte le root (ordine fisico)
+    ConcurrencyTuner *tuner_ = nullptr; // della ricerca corrente, se adattiva
+    ConcurrencyMemory concurrency_memory_;
+    bool concurrency_loaded_ = false;
+    std::atomic<size_t> reported_{0}; // risultati emessi nella ricerca corrente
+    std::vector<std::filesystem::path> search_roots_; // della ricerca corrente, per SearchResult::root
+    SearchArena arena_; // strutture della ricerca corrente, rese in blocco alla fine
+
+    FileFilter file_filter_;
+
+    // Dedup: verdetti per inode/contenuto della ricerca corrente, hash dei
+    // contenuti validi tra una ricerca e l'altra
+    DedupTable inode_table_{arena_.resource()};
+    DedupTable content_table_{arena_.resource()};
+    ContentHashCache hash_cache_;
+    std::atomic<size_t> stats_files_scanned_{0};
+    std::atomic<size_t> stats_files_deduplicated_{0};
+    ContentCache content_cache_;
+    std::atomic<size_t> stats_cache_hits_{0};
+    std::atomic<size_t> stats_cache_misses_{0};
+    SearchProgress progress_;
+    HitHistory hit_history_;
+    ScanOrder scan_order_; // della ricerca corrente
+    std::filesystem::path snapshot_dir_;
 
     // Fast-path letterale: se il pattern non contiene metacaratteri regex,
     // si usa una ricerca substring case-insensitive (molto più veloce di std::regex).
     bool        m_isLiteral = false;
-    std::string m_literalLower; // pattern in minuscolo per il confronto case-insensitive
+    std::string m_literalLower;  // pattern in minuscolo (ranking, ordine di scansione)
+    std::string m_literalNeedle; // quello cercato: m_literalLower, o il pattern se case-sensitive
+    std::string m_literalWide;   // lo stesso in UTF-16LE (FString non ASCII), cercato nello stesso passaggio
+    ApproximatePattern m_approximate; // con m_maxEdits > 0; non valido = ricerca esatta
+
+    // Query booleana (AND/OR/NOT, vedi BooleanQuery): il pattern usa la sua
+    // sintassi. m_literalLower è il primo termine cercato, m_literalNeedle lo
+    // stesso con il case richiesto (match sul nome).
+    bool         m_isQuery = false;
+    BooleanQuery m_query;
+
+    // Indice dei nomi, ricostruito ad ogni walk completo
+    bool m_namesOnly = false;
+    bool m_retainResults = true; // false durante stream(): i risultati vanno solo al consumatore
+    bool m_searchPaks = false;
+    mutable std::mutex path_index_mutex_;
+    PathIndex path_index_;
+    std::vector<std::filesystem::path> path_index_roots_; // root coperte da path_index_
+    std::string path_index_filter_;                       // firma del FileFilter usato
+    bool path_index_complete_ = false;
 };
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "SearchProgress.h"
+#include <chrono>
+
+static int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+size_t SearchProgress::slot_index()
+{
+    // Assegnato alla prima chiamata di ogni thread, poi solo una lettura TLS
+    static std::atomic<size_t> next{0};
+    thread_local const size_t index = next.fetch_add(1, std::memory_order_relaxed) % kSlots;
+    return index;
+}
+
+void SearchProgress::start()
+{
+    for (auto& slot : slots_) {
+        slot.files.store(0, std::memory_order_relaxed);
+        slot.bytes.store(0, std::memory_order_relaxed);
+    }
+    files_total_ = 0;
+    bytes_total_ = 0;
+    end_ns_ = 0;
+    start_ns_ = now_ns();
+}
+
+void SearchProgress::finish()
+{
+    end_ns_ = now_ns();
+}
+
+void SearchProgress::add_total(uint64_t files, uint64_t bytes)
+{
+    files_total_.fetch_add(files, std::memory_order_relaxed);
+    bytes_total_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+SearchProgress::Snapshot SearchProgress::snapshot() const
+{
+    Snapshot s;
+    for (const auto& slot : slots_) {
+        s.files_done += slot.files.load(std::memory_order_relaxed);
+        s.bytes_done += slot.bytes.load(std::memory_order_relaxed);
+    }
+    s.files_total = files_total_.load(std::memory_order_relaxed);
+    s.bytes_total = bytes_total_.load(std::memory_order_relaxed);
+
+    const int64_t start = start_ns_.load();
+    if (start == 0) {
+        return s;
+    }
+    const int64_t end = end_ns_.load();
+    s.elapsed_seconds = ((end != 0 ? end : now_ns()) - start) / 1e9;
+    if (s.elapsed_seconds <= 0.0) {
+        return s;
+    }
+    s.files_per_second = s.files_done / s.elapsed_seconds;
+    s.bytes_per_second = s.bytes_done / s.elapsed_seconds;
+
+    // Stima sui byte (i file hanno taglie molto diverse), sui file se i
+    // byte non dicono niente (solo cache hit o file vuoti)
+    if (end != 0 || (s.files_total > 0 && s.files_done >= s.files_total)) {
+        s.eta_seconds = 0.0;
+    } else if (s.bytes_per_second > 0.0 && s.bytes_total > s.bytes_done) {
+        s.eta_seconds = (s.bytes_total - s.bytes_done) / s.bytes_per_second;
+    } else if (s.files_per_second > 0.0 && s.files_total > s.files_done) {
+        s.eta_seconds = (s.files_total - s.files_done) / s.files_per_second;
+    }
+    return s;
+}
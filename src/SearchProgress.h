@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Avanzamento di una ricerca, letto dalla UI a ogni frame.
+//
+// I worker incrementano contatori per thread (un atomic relaxed su una linea
+// di cache propria, niente stringhe né lock); la UI somma gli slot quando
+// disegna. I totali crescono man mano che i walk delle varie root finiscono.
+class SearchProgress
+{
+public:
+    struct Snapshot
+    {
+        uint64_t files_done = 0;
+        uint64_t files_total = 0;
+        uint64_t bytes_done = 0;
+        uint64_t bytes_total = 0;
+        double elapsed_seconds = 0.0;
+        double files_per_second = 0.0;
+        double bytes_per_second = 0.0;
+        double eta_seconds = -1.0; // -1 = non ancora stimabile
+    };
+
+    void start();  // azzera tutto e fa partire il cronometro
+    void finish(); // ferma il cronometro: velocità e tempo restano leggibili
+
+    // Nuovi file in coda (una root o un archivio appena elencati)
+    void add_total(uint64_t files, uint64_t bytes);
+
+    // Hot path: un file finito, letto o saltato
+    void add_done(uint64_t bytes)
+    {
+        Slot &slot = slots_[slot_index()];
+        slot.files.fetch_add(1, std::memory_order_relaxed);
+        slot.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    Snapshot snapshot() const;
+
+private:
+    static constexpr size_t kSlots = 64; // oltre, più thread condividono uno slot
+
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> files{0};
+        std::atomic<uint64_t> bytes{0};
+    };
+
+    static size_t slot_index();
+
+    std::array<Slot, kSlots> slots_;
+    std::atomic<uint64_t> files_total_{0};
+    std::atomic<uint64_t> bytes_total_{0};
+    std::atomic<int64_t> start_ns_{0};
+    std::atomic<int64_t> end_ns_{0}; // 0 = in corso
+};
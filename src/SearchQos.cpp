@@ -0,0 +1,283 @@
+#include "SearchQos.h"
+#include "LocalIpc.h"
+#include <algorithm>
+#include <filesystem>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <pthread.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <cstdio>
+#endif
+
+namespace SearchQos
+{
+#ifdef __linux__
+// ioprio_set non ha wrapper in glibc
+static constexpr int kIoprioWhoProcess = 1; // su Linux un tid indica il thread
+static constexpr int kIoprioClassShift = 13;
+static constexpr int kIoprioClassIdle = 3;
+
+static long current_tid() { return syscall(SYS_gettid); }
+#endif
+
+BackgroundThread::BackgroundThread()
+{
+#ifdef _WIN32
+    applied_ = SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN) != 0;
+#elif defined(__linux__)
+    const long tid = current_tid();
+    errno = 0;
+    old_nice_ = getpriority(PRIO_PROCESS, static_cast<id_t>(tid));
+    if (errno != 0) old_nice_ = 0;
+    sched_param param{};
+    pthread_getschedparam(pthread_self(), &old_policy_, &param);
+    old_ioprio_ = static_cast<int>(syscall(SYS_ioprio_get, kIoprioWhoProcess, tid));
+
+    setpriority(PRIO_PROCESS, static_cast<id_t>(tid), 19);
+    sched_param idle{};
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &idle);
+    syscall(SYS_ioprio_set, kIoprioWhoProcess, tid, kIoprioClassIdle << kIoprioClassShift);
+    applied_ = true;
+#elif defined(__APPLE__)
+    applied_ = setpriority(PRIO_DARWIN_THREAD, 0, PRIO_DARWIN_BG) == 0;
+#endif
+}
+
+BackgroundThread::~BackgroundThread()
+{
+    if (!applied_) return;
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_END);
+#elif defined(__linux__)
+    // Senza CAP_SYS_NICE il nice non si può rialzare: il thread resta "gentile",
+    // ma i thread di std::async non vengono riusati
+    const long tid = current_tid();
+    sched_param param{};
+    pthread_setschedparam(pthread_self(), old_policy_, &param);
+    setpriority(PRIO_PROCESS, static_cast<id_t>(tid), old_nice_);
+    if (old_ioprio_ >= 0) {
+        syscall(SYS_ioprio_set, kIoprioWhoProcess, tid, old_ioprio_);
+    }
+#elif defined(__APPLE__)
+    setpriority(PRIO_DARWIN_THREAD, 0, 0);
+#endif
+}
+
+// File di lock comune ai processi dell'utente: chi cerca in primo piano
+// tiene un lock condiviso, chi è in background prova quello esclusivo
+static constexpr intptr_t kNoLock = -1;
+
+static intptr_t open_foreground_lock()
+{
+    const std::filesystem::path dir = private_temp_dir();
+    if (dir.empty()) return kNoLock;
+    const std::filesystem::path path = dir / "foreground.lock";
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    return file == INVALID_HANDLE_VALUE ? kNoLock : reinterpret_cast<intptr_t>(file);
+#else
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | O_NOFOLLOW, 0600);
+    return fd < 0 ? kNoLock : fd;
+#endif
+}
+
+static void close_foreground_lock(intptr_t lock)
+{
+    if (lock == kNoLock) return;
+#ifdef _WIN32
+    CloseHandle(reinterpret_cast<HANDLE>(lock)); // rilascia anche il lock
+#else
+    ::close(static_cast<int>(lock));
+#endif
+}
+
+// exclusive: prova senza attendere; condiviso: attende (l'esclusivo di una
+// prova dura pochi microsecondi)
+static bool lock_foreground(intptr_t lock, bool exclusive)
+{
+#ifdef _WIN32
+    OVERLAPPED overlapped = {};
+    const DWORD flags = exclusive ? LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY : 0;
+    return LockFileEx(reinterpret_cast<HANDLE>(lock), flags, 0, 1, 0, &overlapped) != 0;
+#else
+    return ::flock(static_cast<int>(lock), exclusive ? LOCK_EX | LOCK_NB : LOCK_SH) == 0;
+#endif
+}
+
+static void unlock_foreground(intptr_t lock)
+{
+#ifdef _WIN32
+    OVERLAPPED overlapped = {};
+    UnlockFileEx(reinterpret_cast<HANDLE>(lock), 0, 1, 0, &overlapped);
+#else
+    ::flock(static_cast<int>(lock), LOCK_UN);
+#endif
+}
+
+static std::atomic<int> g_foreground{0};
+
+ForegroundScope::ForegroundScope()
+{
+    ++g_foreground;
+    lock_ = open_foreground_lock();
+    if (lock_ != kNoLock && !lock_foreground(lock_, false)) {
+        close_foreground_lock(lock_);
+        lock_ = kNoLock;
+    }
+}
+
+ForegroundScope::~ForegroundScope()
+{
+    close_foreground_lock(lock_);
+    --g_foreground;
+}
+
+bool ForegroundScope::active()
+{
+    if (g_foreground.load(std::memory_order_relaxed) > 0) {
+        return true;
+    }
+    // Un altro processo in primo piano tiene il lock condiviso: l'esclusivo
+    // fallisce. Un solo handle per processo, una prova alla volta.
+    static std::mutex mutex;
+    static const intptr_t probe = open_foreground_lock();
+    if (probe == kNoLock) {
+        return false;
+    }
+    std::scoped_lock<std::mutex> lock(mutex);
+    if (!lock_foreground(probe, true)) {
+        return true;
+    }
+    unlock_foreground(probe);
+    return false;
+}
+
+// Tempi cumulativi di CPU: totale della macchina, occupato, e di questo processo
+struct CpuTimes
+{
+    double total = 0.0;
+    double busy = 0.0;
+    double own = 0.0;
+};
+
+#ifdef _WIN32
+static double filetime_seconds(const FILETIME& ft)
+{
+    return ((static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime) / 1e7;
+}
+
+static bool read_cpu_times(CpuTimes& t)
+{
+    FILETIME idle, kernel, user, created, exited, pkernel, puser;
+    if (!GetSystemTimes(&idle, &kernel, &user) ||
+        !GetProcessTimes(GetCurrentProcess(), &created, &exited, &pkernel, &puser)) {
+        return false;
+    }
+    t.total = filetime_seconds(kernel) + filetime_seconds(user); // kernel include idle
+    t.busy = t.total - filetime_seconds(idle);
+    t.own = filetime_seconds(pkernel) + filetime_seconds(puser);
+    return true;
+}
+#elif defined(__linux__)
+static bool read_cpu_times(CpuTimes& t)
+{
+    FILE* stat = std::fopen("/proc/stat", "r");
+    if (stat == nullptr) return false;
+    unsigned long long user = 0, nice = 0, system = 0, idle = 0, iowait = 0, irq = 0, softirq = 0, steal = 0;
+    const int fields = std::fscanf(stat, "cpu %llu %llu %llu %llu %llu %llu %llu %llu",
+                                   &user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal);
+    std::fclose(stat);
+    if (fields < 4) return false;
+
+    const double tick = static_cast<double>(sysconf(_SC_CLK_TCK));
+    const unsigned long long busy = user + nice + system + irq + softirq + steal;
+    t.total = (busy + idle + iowait) / tick;
+    t.busy = busy / tick;
+
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    t.own = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+            usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+    return true;
+}
+#else
+static bool read_cpu_times(CpuTimes&)
+{
+    return false;
+}
+#endif
+
+double others_cpu_load()
+{
+    static std::mutex mutex;
+    static CpuTimes last;
+    static bool have_last = false;
+    static std::chrono::steady_clock::time_point last_time;
+    static double load = 0.0;
+
+    std::scoped_lock<std::mutex> lock(mutex);
+    const auto now = std::chrono::steady_clock::now();
+    if (have_last && now - last_time < std::chrono::milliseconds(500)) {
+        return load;
+    }
+    CpuTimes current;
+    if (!read_cpu_times(current)) {
+        return 0.0;
+    }
+    if (have_last && current.total > last.total) {
+        const double others = (current.busy - last.busy) - (current.own - last.own);
+        load = std::clamp(others / (current.total - last.total), 0.0, 1.0);
+    }
+    last = current;
+    last_time = now;
+    have_last = true;
+    return load;
+}
+
+void Throttle::reset(uint64_t bytes_per_second)
+{
+    std::scoped_lock<std::mutex> lock(mutex_);
+    rate_ = bytes_per_second;
+    next_free_ = std::chrono::steady_clock::now();
+}
+
+void Throttle::before_file(uint64_t bytes, const std::atomic<bool>& stop)
+{
+    using namespace std::chrono;
+
+    // Pausa: ricerca in primo piano o sistema occupato da altri
+    while (!stop && (ForegroundScope::active() || others_cpu_load() > kBusyLoad)) {
+        std::this_thread::sleep_for(milliseconds(20));
+    }
+
+    // Banda: ogni file prenota il suo tempo di trasferimento al tetto dato
+    steady_clock::time_point start;
+    {
+        std::scoped_lock<std::mutex> lock(mutex_);
+        if (rate_ == 0) return;
+        const auto now = steady_clock::now();
+        start = std::max(now, next_free_);
+        next_free_ = start + duration_cast<steady_clock::duration>(duration<double>(static_cast<double>(bytes) / rate_));
+    }
+    while (!stop && steady_clock::now() < start) {
+        std::this_thread::sleep_for(std::min<steady_clock::duration>(start - steady_clock::now(), milliseconds(20)));
+    }
+}
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+// Ricerche in background: scansioni lunghe o indicizzazione lasciate girare
+// con l'editor aperto, senza rubargli CPU e disco.
+//
+// I worker di una ricerca in background girano con priorità CPU e I/O minime,
+// rispettano un tetto di banda e si fermano tra un file e l'altro finché il
+// sistema è occupato da altri o una ricerca in primo piano è in corso, in
+// questo processo (es. il daemon) o in un altro (GUI, CLI).
+namespace SearchQos
+{
+// Abbassa CPU e I/O del thread corrente finché l'oggetto vive:
+// SCHED_IDLE + nice 19 + ioprio IDLE su Linux, PRIO_DARWIN_BG su macOS,
+// THREAD_MODE_BACKGROUND su Windows. I fallimenti sono ignorati.
+class BackgroundThread
+{
+public:
+    BackgroundThread();
+    ~BackgroundThread();
+
+    BackgroundThread(const BackgroundThread &) = delete;
+    BackgroundThread &operator=(const BackgroundThread &) = delete;
+
+private:
+    bool applied_ = false;
+    int old_nice_ = 0;
+    int old_policy_ = 0;
+    int old_ioprio_ = -1;
+};
+
+// Una ricerca in primo piano in corso: le ricerche in background si mettono
+// in pausa finché ne esiste almeno una. Tra processi dello stesso utente
+// il segnale è un lock condiviso su un file nella sua directory privata
+// (private_temp_dir), che il sistema rilascia anche se il processo muore.
+class ForegroundScope
+{
+public:
+    ForegroundScope();
+    ~ForegroundScope();
+
+    ForegroundScope(const ForegroundScope &) = delete;
+    ForegroundScope &operator=(const ForegroundScope &) = delete;
+
+    // In questo processo o in un altro
+    static bool active();
+
+private:
+    intptr_t lock_ = -1; // fd o HANDLE del file di lock
+};
+
+// Quota di CPU usata dagli altri processi (0..1), escluso questo.
+// Campionata al più ogni mezzo secondo; 0 dove non si sa misurarla.
+double others_cpu_load();
+
+// Cancello tra un file e l'altro per i worker di una ricerca in background
+class Throttle
+{
+public:
+    static constexpr double kBusyLoad = 0.6; // sopra, il sistema è "occupato"
+
+    // bytes_per_second == 0: nessun tetto di banda
+    void reset(uint64_t bytes_per_second);
+
+    // Prima di leggere un file di bytes byte: aspetta finché c'è una ricerca
+    // in primo piano, il sistema è occupato o la banda è esaurita.
+    // Ritorna subito se stop diventa true.
+    void before_file(uint64_t bytes, const std::atomic<bool> &stop);
+
+private:
+    std::mutex mutex_;
+    uint64_t rate_ = 0;
+    std::chrono::steady_clock::time_point next_free_{}; // quando la banda torna disponibile
+};
+}
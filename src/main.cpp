@@ -1,4 +1,5 @@
 #include "SearchAssetsGUI.h"
+#include "SearchCLI.h"
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
@@ -15,8 +16,14 @@ static void glfw_error_callback(int error, const char *description)
     std::cerr << "GLFW Error " << error << ": " << description << std::endl;
 }
 
-int main()
+int main(int argc, char **argv)
 {
+    // Con argomenti: ricerca da riga di comando, senza aprire la finestra
+    if (argc > 1)
+    {
+        return run_cli(argc, argv);
+    }
+
     std::cout << "Starting SearchAssets ImGui...\n";
 
     // Setup GLFW
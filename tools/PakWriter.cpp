@@ -0,0 +1,255 @@
+#include "PakWriter.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <zlib.h>
+
+namespace
+{
+constexpr uint32_t kPakMagic = 0x5A6F12E1;
+
+// EPakFileVersion, come in PakFile.cpp
+constexpr int32_t kVersionIndexEncryption      = 4;
+constexpr int32_t kVersionRelativeChunkOffsets = 5;
+constexpr int32_t kVersionEncryptionKeyGuid    = 7;
+constexpr int32_t kVersionFNameCompression     = 8;
+constexpr int32_t kVersionPathHashIndex        = 10;
+
+constexpr size_t kCompressionNameSize  = 32;
+constexpr size_t kCompressionNameSlots = 5; // FPakInfo::CompressionMethods
+constexpr uint32_t kZlibMethod         = 1; // indice 1 = primo nome, "Zlib"
+
+template <typename T>
+void put(std::string& out, T value)
+{
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+// FString ASCII: lunghezza col terminatore, 0 per la stringa vuota
+void put_string(std::string& out, const std::string& text)
+{
+    if (text.empty()) {
+        put<int32_t>(out, 0);
+        return;
+    }
+    put<int32_t>(out, static_cast<int32_t>(text.size() + 1));
+    out.append(text);
+    out.push_back('\0');
+}
+
+void put_zeros(std::string& out, size_t count)
+{
+    out.append(count, '\0');
+}
+} // namespace
+
+PakWriter::PakWriter(int32_t version, std::string mount_point)
+    : version_(version), mount_point_(std::move(mount_point))
+{
+}
+
+// FPakEntry::GetSerializedSize (senza timestamp: v2+)
+uint64_t PakWriter::record_size(const Written& entry) const
+{
+    uint64_t size = 8 + 8 + 8 + 4 + 20 + 1 + 4;
+    if (entry.compressed) {
+        size += 4 + 16 * static_cast<uint64_t>(entry.block_starts.size());
+    }
+    return size;
+}
+
+// FPakEntry serializzata per esteso: davanti ai dati e nell'indice pre-v10
+void PakWriter::append_record(std::string& out, const Written& entry) const
+{
+    put<int64_t>(out, static_cast<int64_t>(entry.offset));
+    put<int64_t>(out, static_cast<int64_t>(entry.size));
+    put<int64_t>(out, static_cast<int64_t>(entry.uncompressed_size));
+    if (version_ < kVersionFNameCompression) {
+        put<int32_t>(out, entry.compressed ? 0x01 : 0); // COMPRESS_ZLIB
+    } else {
+        put<uint32_t>(out, entry.compressed ? kZlibMethod : 0);
+    }
+    put_zeros(out, 20); // SHA1
+    if (entry.compressed) {
+        put<int32_t>(out, static_cast<int32_t>(entry.block_starts.size()));
+        for (size_t b = 0; b < entry.block_starts.size(); ++b) {
+            put<int64_t>(out, static_cast<int64_t>(entry.block_starts[b]));
+            put<int64_t>(out, static_cast<int64_t>(entry.block_ends[b]));
+        }
+    }
+    put<uint8_t>(out, 0); // flag: non cifrata
+    put<uint32_t>(out, entry.compressed ? kBlockSize : 0);
+}
+
+// FPakFile::EncodePakEntry (v10+)
+void PakWriter::append_encoded(std::string& out, const Written& entry) const
+{
+    const uint32_t method = entry.compressed ? kZlibMethod : 0;
+    const uint32_t block_count = static_cast<uint32_t>(entry.block_starts.size());
+    const bool offset32 = entry.offset <= UINT32_MAX;
+    const bool uncompressed32 = entry.uncompressed_size <= UINT32_MAX;
+    const bool size32 = entry.size <= UINT32_MAX;
+
+    uint32_t bits = entry.compressed ? kBlockSize >> 11 : 0;
+    bits |= block_count << 6;
+    bits |= method << 23;
+    bits |= (size32 ? 1u : 0u) << 29;
+    bits |= (uncompressed32 ? 1u : 0u) << 30;
+    bits |= (offset32 ? 1u : 0u) << 31;
+    put<uint32_t>(out, bits);
+
+    if (offset32) put<uint32_t>(out, static_cast<uint32_t>(entry.offset));
+    else          put<int64_t>(out, static_cast<int64_t>(entry.offset));
+    if (uncompressed32) put<uint32_t>(out, static_cast<uint32_t>(entry.uncompressed_size));
+    else                put<int64_t>(out, static_cast<int64_t>(entry.uncompressed_size));
+    if (method != 0) {
+        if (size32) put<uint32_t>(out, static_cast<uint32_t>(entry.size));
+        else        put<int64_t>(out, static_cast<int64_t>(entry.size));
+        // Un solo blocco: la sua lunghezza è la size
+        if (block_count > 1) {
+            for (uint32_t b = 0; b < block_count; ++b) {
+                put<uint32_t>(out, static_cast<uint32_t>(entry.block_ends[b] - entry.block_starts[b]));
+            }
+        }
+    }
+}
+
+bool PakWriter::write(const std::filesystem::path& path) const
+{
+    if (version_ != 3 && version_ != 8 && version_ != 11) {
+        return false;
+    }
+
+    // Dati: per ogni entry l'header serializzato (offset a 0, come fa UE)
+    // seguito dal contenuto, compresso un blocco alla volta
+    std::string pak;
+    std::vector<Written> written;
+    written.reserve(entries_.size());
+    for (const Entry& source : entries_) {
+        Written entry;
+        entry.offset = pak.size();
+        entry.uncompressed_size = source.declared_size != 0 ? source.declared_size : source.data.size();
+        entry.compressed = source.compressed;
+
+        std::vector<std::string> blocks;
+        if (source.compressed) {
+            for (size_t pos = 0; pos < source.data.size(); pos += kBlockSize) {
+                const size_t length = std::min<size_t>(kBlockSize, source.data.size() - pos);
+                uLongf packed_size = compressBound(static_cast<uLong>(length));
+                std::string packed(packed_size, '\0');
+                if (compress2(reinterpret_cast<Bytef*>(packed.data()), &packed_size,
+                              reinterpret_cast<const Bytef*>(source.data.data() + pos),
+                              static_cast<uLong>(length), Z_BEST_SPEED) != Z_OK) {
+                    return false;
+                }
+                packed.resize(packed_size);
+                blocks.push_back(std::move(packed));
+            }
+            entry.block_starts.resize(blocks.size());
+            entry.block_ends.resize(blocks.size());
+        } else {
+            entry.size = source.data.size();
+        }
+
+        // Posizioni dei blocchi: note solo dopo la size dell'header, che
+        // dipende dal loro numero
+        const uint64_t base = version_ >= kVersionRelativeChunkOffsets ? 0 : entry.offset;
+        uint64_t position = record_size(entry);
+        for (size_t b = 0; b < blocks.size(); ++b) {
+            entry.block_starts[b] = base + position;
+            position += blocks[b].size();
+            entry.block_ends[b] = base + position;
+            entry.size += blocks[b].size();
+        }
+
+        Written header = entry;
+        header.offset = 0;
+        append_record(pak, header);
+        if (source.compressed) {
+            for (const std::string& block : blocks) {
+                pak.append(block);
+            }
+        } else {
+            pak.append(source.data);
+        }
+        written.push_back(std::move(entry));
+    }
+
+    // Indice
+    const uint64_t index_offset = pak.size();
+    std::string index;
+    put_string(index, mount_point_);
+    put<int32_t>(index, static_cast<int32_t>(entries_.size()));
+    std::string directory_index;
+    if (version_ < kVersionPathHashIndex) {
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            put_string(index, entries_[i].path);
+            append_record(index, written[i]);
+        }
+    } else {
+        // Entry codificate in un blob; i nomi, per directory, nel directory
+        // index, che punta nel blob
+        std::string encoded;
+        std::map<std::string, std::vector<std::pair<std::string, int32_t>>> directories;
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            const std::string& entry_path = entries_[i].path;
+            const size_t slash = entry_path.rfind('/');
+            const std::string dir = slash == std::string::npos ? "/" : entry_path.substr(0, slash + 1);
+            const std::string name = slash == std::string::npos ? entry_path : entry_path.substr(slash + 1);
+            directories[dir].emplace_back(name, static_cast<int32_t>(encoded.size()));
+            append_encoded(encoded, written[i]);
+        }
+
+        put<int32_t>(directory_index, static_cast<int32_t>(directories.size()));
+        for (const auto& [dir, files] : directories) {
+            put_string(directory_index, dir);
+            put<int32_t>(directory_index, static_cast<int32_t>(files.size()));
+            for (const auto& [name, location] : files) {
+                put_string(directory_index, name);
+                put<int32_t>(directory_index, location);
+            }
+        }
+
+        // La dimensione dell'indice primario non dipende dall'offset del
+        // directory index: si calcola prima di scriverlo
+        const uint64_t primary_size = index.size() + 8 + 4 + 4 + 8 + 8 + 20 + 4 + encoded.size() + 4;
+        put<uint64_t>(index, 0);  // PathHashSeed
+        put<uint32_t>(index, 0);  // niente path hash index
+        put<uint32_t>(index, 1);  // directory index presente
+        put<int64_t>(index, static_cast<int64_t>(index_offset + primary_size));
+        put<int64_t>(index, static_cast<int64_t>(directory_index.size()));
+        put_zeros(index, 20);
+        put<int32_t>(index, static_cast<int32_t>(encoded.size()));
+        index.append(encoded);
+        put<int32_t>(index, 0);   // nessuna entry non codificabile
+    }
+    pak.append(index);
+    pak.append(directory_index);
+
+    // FPakInfo
+    if (version_ >= kVersionEncryptionKeyGuid) {
+        put_zeros(pak, 16);
+    }
+    if (version_ >= kVersionIndexEncryption) {
+        put<uint8_t>(pak, 0); // indice in chiaro
+    }
+    put<uint32_t>(pak, kPakMagic);
+    put<int32_t>(pak, version_);
+    put<int64_t>(pak, static_cast<int64_t>(index_offset));
+    put<int64_t>(pak, static_cast<int64_t>(index.size()));
+    put_zeros(pak, 20);
+    if (version_ >= kVersionFNameCompression) {
+        std::string name = "Zlib";
+        name.resize(kCompressionNameSize, '\0');
+        pak.append(name);
+        put_zeros(pak, kCompressionNameSize * (kCompressionNameSlots - 1));
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(pak.data(), static_cast<std::streamsize>(pak.size()));
+    return static_cast<bool>(out);
+}
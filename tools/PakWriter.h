@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Scrittore minimo di archivi .pak di Unreal, per produrre archivi di prova
+// per PakFile (versioni 3, 8 e 11).
+//
+// Copre quello che il lettore sa leggere: entry non compresse o compresse
+// Zlib a blocchi, indice in chiaro, per la v11 entry codificate e directory
+// index. Niente cifratura, hash SHA1 a zero.
+class PakWriter
+{
+public:
+    struct Entry
+    {
+        std::string path; // relativo al mount point, separatore '/'
+        std::string data;
+        bool compressed = false;
+        // Solo per le verifiche sugli archivi malformati: se != 0 finisce
+        // nell'indice al posto della size decompressa vera
+        uint64_t declared_size = 0;
+    };
+
+    static constexpr uint32_t kBlockSize = 64 * 1024;
+
+    // version: 3, 8 o 11. mount_point come in UE, es. "../../../Game/Content/"
+    PakWriter(int32_t version, std::string mount_point);
+
+    void add(Entry entry) { entries_.push_back(std::move(entry)); }
+
+    // false se la versione non è supportata o il file non si può scrivere
+    bool write(const std::filesystem::path &path) const;
+
+private:
+    struct Written
+    {
+        uint64_t offset = 0;
+        uint64_t size = 0; // byte su disco
+        uint64_t uncompressed_size = 0;
+        std::vector<uint64_t> block_starts; // relativi a offset (v5+) o assoluti
+        std::vector<uint64_t> block_ends;
+        bool compressed = false;
+    };
+
+    void append_record(std::string &out, const Written &entry) const;
+    uint64_t record_size(const Written &entry) const;
+    void append_encoded(std::string &out, const Written &entry) const;
+
+    int32_t version_;
+    std::string mount_point_;
+    std::vector<Entry> entries_;
+};